@@ -1,28 +1,239 @@
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <new>
+#include <ostream>
+
 #include "allocator.h"
 
-Allocator::Allocator(size_t maxSize) {
-    makeAllocator(maxSize);
+#ifdef ALLOCATOR_STATS
+#define COUNT(counter, value) (_counters.counter += (value))
+#else
+#define COUNT(counter, value) static_cast<void>(0)
+#endif
+
+namespace {
+
+constexpr size_t HUGE_PAGE_SIZE = 2u << 20;
+
+size_t RoundUp(size_t size, size_t granularity) {
+    return (size + granularity - 1u) / granularity * granularity;
+}
+
+char* MapAnonymous(size_t size, int flags) {
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+    return mem == MAP_FAILED ? nullptr : static_cast<char*>(mem);
 }
 
-void Allocator::makeAllocator(size_t maxSize) {
-    _mem =  std::make_unique<char[]>(maxSize);
-    _offset  = _mem.get();
+}  // namespace
+
+void Allocator::BlockDeleter::operator()(char* mem) const {
+    if (page != 0u) {
+        munmap(mem, size);
+    } else {
+        delete[] mem;
+    }
+}
+
+Allocator::Allocator(size_t maxSize, Growth growth, Backing backing) {
+    makeAllocator(maxSize, growth, backing);
+}
+
+void Allocator::makeAllocator(size_t maxSize, Growth growth, Backing backing) {
+    _blocks.clear();
+    _backing = backing;
+    _blocks.push_back(make_block(maxSize));
     _maxSize = maxSize;
+    _growth = growth;
+    _used = _peak = _cyclePeak = 0u;
+    _counters = {};
+    use_block(0u);
+}
+
+Allocator::Block Allocator::make_block(size_t size) const {
+    if (_backing == Backing::Heap || size == 0u) {
+        return {{new char[size], {size, 0u}}, size};
+    }
+
+    char* mem = nullptr;
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t length = RoundUp(size, page);
+#ifdef MAP_HUGETLB
+    // hugetlb pages must be reserved up front, otherwise the first touch
+    // of a page which cannot be provided raises SIGBUS
+    if (_backing == Backing::HugePages) {
+        size_t huge_length = RoundUp(size, HUGE_PAGE_SIZE);
+        if ((mem = MapAnonymous(huge_length, MAP_HUGETLB)) != nullptr) {
+            page = HUGE_PAGE_SIZE;
+            length = huge_length;
+        }
+    }
+#endif
+    if (mem == nullptr) {
+        mem = MapAnonymous(length, MAP_NORESERVE);
+        if (mem == nullptr) {
+            throw std::bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        if (_backing == Backing::HugePages) {
+            madvise(mem, length, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    return {{mem, {length, page}}, size};
 }
 
 char* Allocator::alloc(size_t size) {
-    if (_offset + size > _mem.get() + _maxSize) {
-        return nullptr;
+    if (size > static_cast<size_t>(_end - _offset)) {
+        return grow(size, 1u);
     }
     char* ptr = _offset;
     _offset += size;
+    COUNT(allocations, 1u);
     return ptr;
 }
 
+char* Allocator::alloc(size_t size, size_t alignment) {
+    if (alignment == 0u || (alignment & (alignment - 1u)) != 0u) {
+        COUNT(failures, 1u);
+        return nullptr;
+    }
+    void* ptr = _offset;
+    size_t space = _end - _offset;
+    if (std::align(alignment, size, ptr, space) == nullptr) {
+        return grow(size, alignment);
+    }
+    COUNT(padding, static_cast<char*>(ptr) - _offset);
+    COUNT(allocations, 1u);
+    _offset = static_cast<char*>(ptr) + size;
+    return static_cast<char*>(ptr);
+}
+
+char* Allocator::alloc_line(size_t size) {
+    size_t lines = size / CACHE_LINE_SIZE + (size % CACHE_LINE_SIZE != 0u);
+    char* ptr = alloc(lines * CACHE_LINE_SIZE, CACHE_LINE_SIZE);
+    if (ptr != nullptr) {
+        COUNT(padding, lines * CACHE_LINE_SIZE - size);
+    }
+    return ptr;
+}
+
+char* Allocator::grow(size_t size, size_t alignment) {
+    if (_growth == Growth::Fixed || size > std::numeric_limits<size_t>::max() - alignment) {
+        COUNT(failures, 1u);
+        return nullptr;
+    }
+    size_t next = _current + 1u;
+    size_t need = size + alignment - 1u;
+    // blocks past the current one are kept from before a rewind(): the first
+    // one that fits is moved up, the smaller ones stay behind it for reuse
+    auto fits = std::find_if(_blocks.begin() + next, _blocks.end(),
+                             [need](const Block& block) { return block.size >= need; });
+    if (fits != _blocks.end()) {
+        std::rotate(_blocks.begin() + next, fits, std::next(fits));
+    } else {
+        // out of memory is a failed alloc() like any other, not an exception
+        try {
+            _blocks.insert(_blocks.begin() + next,
+                           make_block(std::max(2 * _blocks[_current].size, need)));
+        } catch (const std::bad_alloc&) {
+            COUNT(failures, 1u);
+            return nullptr;
+        }
+    }
+    update_peak();
+    _used = in_use();
+    use_block(next);
+    return alloc(size, alignment);
+}
+
+void Allocator::use_block(size_t index) {
+    _current = index;
+    _offset = _blocks[index].mem.get();
+    _end = _offset + _blocks[index].size;
+}
+
+void Allocator::update_peak() {
+    size_t used = in_use();
+    _peak = std::max(_peak, used);
+    _cyclePeak = std::max(_cyclePeak, used);
+}
+
+size_t Allocator::in_use() const {
+    if (_blocks.empty()) {
+        return 0u;
+    }
+    return _used + (_offset - _blocks[_current].mem.get());
+}
+
 size_t Allocator::max_size() const {
     return _maxSize;
 }
 
-void Allocator::reset() {
-    _offset = _mem.get();
+size_t Allocator::high_water_mark() const {
+    return std::max(_peak, in_use());
+}
+
+size_t Allocator::block_count() const {
+    return _blocks.size();
+}
+
+Allocator::Stats Allocator::stats() const {
+    Stats stats{in_use(), high_water_mark(), 0u, _blocks.size(),
+                _counters.allocations, _counters.failures, _counters.padding};
+    for (const Block& block : _blocks) {
+        stats.capacity += block.size;
+    }
+    return stats;
+}
+
+void Allocator::reset(bool release_tail) {
+    if (_blocks.empty()) {
+        return;
+    }
+    update_peak();
+    size_t keep = _cyclePeak;
+    _used = _cyclePeak = 0u;
+    if (_blocks.size() > 1u) {
+        // not necessarily the last one once grow() reordered cached blocks
+        auto largest = std::max_element(_blocks.begin(), _blocks.end(),
+                                        [](const Block& lhs, const Block& rhs) {
+                                            return lhs.size < rhs.size;
+                                        });
+        std::iter_swap(_blocks.begin(), largest);
+        _blocks.erase(std::next(_blocks.begin()), _blocks.end());
+    }
+    use_block(0u);
+
+    const BlockDeleter& storage = _blocks.front().mem.get_deleter();
+    size_t tail = RoundUp(keep, std::max(storage.page, size_t{1}));
+    if (release_tail && storage.page != 0u && tail < storage.size) {
+        madvise(_offset + tail, storage.size - tail, MADV_DONTNEED);
+    }
+}
+
+Allocator::Marker Allocator::mark() const {
+    return {_current, _offset, _used};
+}
+
+void Allocator::rewind(const Marker& marker) {
+    if (_blocks.empty()) {
+        return;
+    }
+    update_peak();
+    use_block(marker.block);
+    _offset = marker.offset;
+    _used = marker.used;
+}
+
+std::ostream& operator<<(std::ostream& os, const Allocator::Stats& stats) {
+    return os << "{\"in_use\": " << stats.in_use
+              << ", \"peak\": " << stats.peak
+              << ", \"capacity\": " << stats.capacity
+              << ", \"blocks\": " << stats.blocks
+              << ", \"allocations\": " << stats.allocations
+              << ", \"failures\": " << stats.failures
+              << ", \"padding\": " << stats.padding << '}';
 }
@@ -1,11 +1,65 @@
 #ifndef MY_ALLOCATOR
 #define MY_ALLOCATOR
 #include <memory>
+#include <limits>
+#include <vector>
+#include <iosfwd>
+
+constexpr size_t CACHE_LINE_SIZE = 64u;
 
 class Allocator {
+ public:
+    // Fixed:   alloc() returns nullptr once maxSize bytes are used up;
+    // Chained: a new block, at least twice as large as the previous one,
+    //          is chained when the current block is full; alloc() returns
+    //          nullptr if the system has no memory for it.
+    enum class Growth { Fixed, Chained };
+
+    // Heap:      operator new[], memory is not zero-filled;
+    // Mmap:      anonymous mapping, pages are committed on first touch;
+    // HugePages: like Mmap, but backed by huge pages (MAP_HUGETLB if reserved,
+    //            transparent huge pages otherwise).
+    enum class Backing { Heap, Mmap, HugePages };
+
+    // Position in the arena; invalidated by reset() and makeAllocator()
+    struct Marker {
+        size_t block;
+        char* offset;
+        size_t used;
+    };
+
+    // Snapshot of the usage; allocations, failures and padding are only
+    // counted when allocator.cpp is built with -DALLOCATOR_STATS and are
+    // zero otherwise
+    struct Stats {
+        size_t in_use;
+        size_t peak;
+        size_t capacity;
+        size_t blocks;
+        size_t allocations;
+        size_t failures;
+        size_t padding;
+    };
+
+    // Rewinds the allocator to the position it had at construction
+    class Scope {
+     public:
+        explicit Scope(Allocator& alloc) : _alloc(alloc), _marker(alloc.mark()) {}
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        ~Scope() { _alloc.rewind(_marker); }
+
+     private:
+        Allocator& _alloc;
+        Marker _marker;
+    };
+
  public:
     Allocator() = default;
-    explicit Allocator(size_t maxSize);
+    explicit Allocator(size_t maxSize, Growth growth = Growth::Fixed,
+                       Backing backing = Backing::Heap);
 
     Allocator(Allocator&) = delete;
     Allocator& operator=(const Allocator&) = delete;
@@ -13,15 +67,79 @@ class Allocator {
     ~Allocator() = default;
 
  public:
-    void makeAllocator(size_t maxSize);
+    void makeAllocator(size_t maxSize, Growth growth = Growth::Fixed,
+                       Backing backing = Backing::Heap);
     char* alloc(size_t size);
+    // alignment must be a power of two, otherwise nullptr is returned
+    char* alloc(size_t size, size_t alignment);
+    // whole cache lines, so that the block never shares a line with another one
+    char* alloc_line(size_t size);
+
+    template <class T>
+    T* alloc(size_t n = 1u) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+            return nullptr;
+        return reinterpret_cast<T*>(alloc(n * sizeof(T), alignof(T)));
+    }
+
     size_t max_size() const;
-    void reset();
+    // the largest number of bytes (padding included) ever in use at once
+    size_t high_water_mark() const;
+    size_t block_count() const;
+    Stats stats() const;
+    // frees every block except the largest one; with release_tail the pages
+    // of mapped storage past the peak usage since the previous reset are
+    // returned to the system
+    void reset(bool release_tail = false);
+
+    Marker mark() const;
+    // releases everything allocated after the marker, chained blocks are kept for reuse
+    void rewind(const Marker& marker);
+
+ private:
+    struct BlockDeleter {
+        size_t size;
+        // page size of mapped storage, 0 for the heap
+        size_t page;
+        void operator()(char* mem) const;
+    };
+
+    struct Block {
+        std::unique_ptr<char[], BlockDeleter> mem;
+        size_t size;
+    };
 
  private:
-    std::unique_ptr<char[]> _mem = nullptr;
+    char* grow(size_t size, size_t alignment);
+    Block make_block(size_t size) const;
+    void use_block(size_t index);
+    void update_peak();
+    size_t in_use() const;
+
+ private:
+    std::vector<Block> _blocks;
+    size_t _current = 0u;
     size_t _maxSize = 0u;
+    Growth _growth = Growth::Fixed;
+    Backing _backing = Backing::Heap;
+
     char* _offset = nullptr;
+    char* _end = nullptr;
+    // bytes used in the blocks preceding the current one
+    size_t _used = 0u;
+    size_t _peak = 0u;
+    size_t _cyclePeak = 0u;
+
+    // in every build, so the layout does not depend on ALLOCATOR_STATS;
+    // only allocator.cpp looks at the flag to update them
+    struct Counters {
+        size_t allocations = 0u;
+        size_t failures = 0u;
+        size_t padding = 0u;
+    } _counters;
 };
 
+// one JSON object per snapshot
+std::ostream& operator<<(std::ostream& os, const Allocator::Stats& stats);
+
 #endif  // MY_ALLOCATOR
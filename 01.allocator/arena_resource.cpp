@@ -0,0 +1,23 @@
+#include "arena_resource.h"
+
+ArenaResource::ArenaResource(Allocator& arena) noexcept
+    : _arena(arena) {}
+
+Allocator& ArenaResource::arena() const noexcept {
+    return _arena;
+}
+
+void* ArenaResource::do_allocate(size_t bytes, size_t alignment) {
+    char* ptr = _arena.alloc(bytes, alignment);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void ArenaResource::do_deallocate(void*, size_t, size_t) {}
+
+bool ArenaResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    auto res = dynamic_cast<const ArenaResource*>(&other);
+    return res != nullptr && &res->_arena == &_arena;
+}
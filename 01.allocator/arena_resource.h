@@ -0,0 +1,66 @@
+#ifndef MY_ARENA_RESOURCE
+#define MY_ARENA_RESOURCE
+#include <memory_resource>
+#include <new>
+
+#include "allocator.h"
+
+// Monotonic memory resource on top of an Allocator:
+// deallocation is a no-op, memory is reclaimed by the arena's reset()/rewind().
+class ArenaResource : public std::pmr::memory_resource {
+ public:
+    explicit ArenaResource(Allocator& arena) noexcept;
+
+    Allocator& arena() const noexcept;
+
+ private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+ private:
+    Allocator& _arena;
+};
+
+// Allocator for standard containers and Vector<T, Alloc>
+template <typename T>
+class ArenaAllocator {
+ public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+
+ public:
+    explicit ArenaAllocator(Allocator& arena) noexcept : _arena(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : _arena(other._arena) {}
+
+ public:
+    [[nodiscard]]
+    T* allocate(size_type n) {
+        T* ptr = _arena->alloc<T>(n);
+        if (ptr == nullptr)
+            throw std::bad_alloc();
+        return ptr;
+    }
+
+    void deallocate(T*, size_type) noexcept {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept {
+        return _arena == other._arena;
+    }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+ private:
+    template <typename U>
+    friend class ArenaAllocator;
+
+    Allocator* _arena;
+};
+
+#endif  // MY_ARENA_RESOURCE
@@ -0,0 +1,417 @@
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "allocator.h"
+#include "arena_resource.h"
+#include "concurrent_allocator.h"
+#include "size_class_allocator.h"
+
+namespace chr = std::chrono;
+
+// Every benchmark prints CSV rows of the form
+// benchmark,allocator,distribution,threads,ops_per_sec,p50_ns,p99_ns,p999_ns,misses_per_op
+// columns which a benchmark does not measure are left empty.
+// The latency percentiles are over single allocations, one in SAMPLE_EVERY
+// timed on its own, including the write to its first byte.
+
+namespace {
+
+struct Result {
+    double ops_per_sec;
+    std::vector<double> latencies;
+    double misses_per_op = -1.0;
+};
+
+void PrintRow(const std::string& benchmark, const std::string& allocator,
+              const std::string& distribution, size_t threads, Result result) {
+    std::cout << benchmark << ',' << allocator << ',' << distribution << ','
+              << threads << ',' << static_cast<uint64_t>(result.ops_per_sec);
+    auto& lat = result.latencies;
+    std::sort(lat.begin(), lat.end());
+    for (double q : {0.5, 0.99, 0.999}) {
+        std::cout << ',';
+        if (!lat.empty())
+            std::cout << lat[static_cast<size_t>(q * (lat.size() - 1))];
+    }
+    std::cout << ',';
+    if (result.misses_per_op >= 0.0)
+        std::cout << result.misses_per_op;
+    std::cout << '\n';
+}
+
+// Hardware cache-miss counter of the calling thread,
+// stop() returns -1 where perf events are not available.
+class CacheMisses {
+ public:
+    CacheMisses() {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    CacheMisses(const CacheMisses&) = delete;
+    CacheMisses& operator=(const CacheMisses&) = delete;
+
+    ~CacheMisses() {
+        if (fd_ != -1)
+            close(fd_);
+    }
+
+    void start() {
+        if (fd_ == -1)
+            return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    double stop() {
+        uint64_t count = 0u;
+        if (fd_ == -1)
+            return -1.0;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd_, &count, sizeof(count)) != sizeof(count))
+            return -1.0;
+        return static_cast<double>(count);
+    }
+
+ private:
+    int fd_ = -1;
+};
+
+// ------------------------- allocation throughput --------------------------
+
+constexpr size_t NALLOCS      = 1u << 16;  // per thread and round
+constexpr size_t NROUNDS      = 16u;
+constexpr size_t SAMPLE_EVERY = 64u;       // one allocation in this many is timed alone
+
+// Median time of reading steady_clock twice, taken off every latency sample
+double ClockOverheadNs() {
+    std::vector<double> samples(1024u);
+    for (double& sample : samples) {
+        auto start = chr::steady_clock::now();
+        chr::duration<double, std::nano> dur = chr::steady_clock::now() - start;
+        sample = dur.count();
+    }
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+std::vector<size_t> MakeSizes(const std::string& distribution) {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<size_t> sizes(NALLOCS);
+    for (size_t& size : sizes) {
+        if (distribution == "fixed") {
+            size = 32u;
+        } else if (distribution == "power-law") {
+            // Pareto with x_m = 8 and alpha = 1.2, truncated to a page
+            double x = 8.0 / std::pow(1.0 - unit(gen), 1.0 / 1.2);
+            size = std::min<size_t>(static_cast<size_t>(x), 4096u);
+        } else {
+            size = unit(gen) < 0.9 ? 16u : 4096u;
+        }
+    }
+    return sizes;
+}
+
+// state shared by the threads of one run, sized for a whole round
+struct NoShared {
+    explicit NoShared(size_t) {}
+};
+
+struct MallocBench {
+    using Shared = NoShared;
+    explicit MallocBench(Shared&) {}
+
+    void* alloc(size_t size) { return std::malloc(size); }
+    void release(const std::vector<void*>& ptrs, const std::vector<size_t>&) {
+        for (void* ptr : ptrs)
+            std::free(ptr);
+    }
+    static void end_round(Shared&) {}
+};
+
+struct ArenaBench {
+    using Shared = NoShared;
+    explicit ArenaBench(Shared&) : arena(1u << 20, Allocator::Growth::Chained) {}
+
+    void* alloc(size_t size) { return arena.alloc(size); }
+    void release(const std::vector<void*>&, const std::vector<size_t>&) { arena.reset(); }
+    static void end_round(Shared&) {}
+
+    Allocator arena;
+};
+
+struct ConcurrentArenaBench {
+    struct Shared {
+        explicit Shared(size_t round_bytes) : arena(round_bytes) {}
+        ConcurrentAllocator arena;
+    };
+    explicit ConcurrentArenaBench(Shared& shared) : arena(shared.arena) {}
+
+    void* alloc(size_t size) { return arena.alloc(size); }
+    void release(const std::vector<void*>&, const std::vector<size_t>&) {}
+    static void end_round(Shared& shared) { shared.arena.reset(); }
+
+    ConcurrentAllocator& arena;
+};
+
+struct MonotonicBench {
+    using Shared = NoShared;
+    explicit MonotonicBench(Shared&) {}
+
+    void* alloc(size_t size) { return res.allocate(size); }
+    void release(const std::vector<void*>&, const std::vector<size_t>&) { res.release(); }
+    static void end_round(Shared&) {}
+
+    std::pmr::monotonic_buffer_resource res;
+};
+
+struct PoolBench {
+    using Shared = NoShared;
+    explicit PoolBench(Shared&) {}
+
+    void* alloc(size_t size) { return res.allocate(size); }
+    void release(const std::vector<void*>& ptrs, const std::vector<size_t>& sizes) {
+        for (size_t i = 0; i < ptrs.size(); i++)
+            res.deallocate(ptrs[i], sizes[i]);
+    }
+    static void end_round(Shared&) {}
+
+    std::pmr::unsynchronized_pool_resource res;
+};
+
+template <typename Bench>
+Result RunAllocs(const std::vector<size_t>& sizes, size_t nthreads) {
+    typename Bench::Shared shared(nthreads * std::accumulate(sizes.begin(), sizes.end(), size_t{0}));
+    std::vector<std::unique_ptr<Bench>> benches;
+    for (size_t t = 0; t < nthreads; t++)
+        benches.push_back(std::make_unique<Bench>(shared));
+
+    std::vector<std::vector<double>> latencies(nthreads);
+    std::vector<chr::duration<double>> busy(nthreads);
+    const double clock_ns = ClockOverheadNs();
+
+    for (size_t round = 0; round < NROUNDS; round++) {
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < nthreads; t++) {
+            threads.emplace_back([&, t] {
+                std::vector<void*> ptrs(sizes.size());
+                auto start = chr::steady_clock::now();
+                for (size_t i = 0; i < sizes.size(); i++) {
+                    if (i % SAMPLE_EVERY != 0u) {
+                        ptrs[i] = benches[t]->alloc(sizes[i]);
+                        *static_cast<char*>(ptrs[i]) = 0;
+                        continue;
+                    }
+                    auto alloc_start = chr::steady_clock::now();
+                    ptrs[i] = benches[t]->alloc(sizes[i]);
+                    *static_cast<char*>(ptrs[i]) = 0;
+                    chr::duration<double, std::nano> dur = chr::steady_clock::now() - alloc_start;
+                    latencies[t].push_back(std::max(dur.count() - clock_ns, 0.0));
+                }
+                benches[t]->release(ptrs, sizes);
+                busy[t] += chr::steady_clock::now() - start;
+            });
+        }
+        for (auto& thr : threads)
+            thr.join();
+        Bench::end_round(shared);
+    }
+
+    Result result{0.0, {}};
+    for (size_t t = 0; t < nthreads; t++) {
+        result.ops_per_sec += NROUNDS * sizes.size() / busy[t].count();
+        result.latencies.insert(result.latencies.end(), latencies[t].begin(), latencies[t].end());
+    }
+    return result;
+}
+
+void BenchAllocs() {
+    std::vector<size_t> thread_counts = {1u, 2u, 4u, std::thread::hardware_concurrency()};
+    std::sort(thread_counts.begin(), thread_counts.end());
+    thread_counts.erase(std::unique(thread_counts.begin(), thread_counts.end()),
+                        thread_counts.end());
+
+    for (std::string dist : {"fixed", "power-law", "mixed"}) {
+        std::vector<size_t> sizes = MakeSizes(dist);
+        for (size_t nthreads : thread_counts) {
+            if (nthreads == 0u || nthreads > std::thread::hardware_concurrency())
+                continue;
+            PrintRow("alloc", "malloc", dist, nthreads, RunAllocs<MallocBench>(sizes, nthreads));
+            PrintRow("alloc", "arena", dist, nthreads, RunAllocs<ArenaBench>(sizes, nthreads));
+            PrintRow("alloc", "concurrent_arena", dist, nthreads,
+                     RunAllocs<ConcurrentArenaBench>(sizes, nthreads));
+            PrintRow("alloc", "pmr_monotonic", dist, nthreads,
+                     RunAllocs<MonotonicBench>(sizes, nthreads));
+            PrintRow("alloc", "pmr_pool", dist, nthreads, RunAllocs<PoolBench>(sizes, nthreads));
+        }
+    }
+}
+
+// ------------------------- aligned cache lines ----------------------------
+
+struct alignas(CACHE_LINE_SIZE) Line {
+    uint64_t words[CACHE_LINE_SIZE / sizeof(uint64_t)];
+};
+
+constexpr size_t NLINES  = 1u << 16;
+constexpr size_t NPASSES = 64u;
+
+// Every line gets a slot of two cache lines, so both cases touch memory
+// with the same stride. When `aligned` is false the line starts one byte
+// into its slot and is split between two cache lines.
+constexpr size_t SLOT_SIZE = 2 * sizeof(Line);
+
+std::vector<char*> PlaceLines(Allocator& a, bool aligned) {
+    std::vector<char*> lines;
+    lines.reserve(NLINES);
+    for (size_t i = 0; i < NLINES; i++)
+        lines.push_back(a.alloc(SLOT_SIZE, alignof(Line)) + (aligned ? 0u : 1u));
+    return lines;
+}
+
+Result RunLines(bool aligned) {
+    Allocator a(NLINES * SLOT_SIZE + alignof(Line));
+    std::vector<char*> lines = PlaceLines(a, aligned);
+
+    uint64_t sum = 0u;
+    auto start = chr::steady_clock::now();
+    for (size_t pass = 0; pass < NPASSES; pass++) {
+        for (char* ptr : lines) {
+            Line line;
+            std::memcpy(&line, ptr, sizeof(Line));
+            for (uint64_t& w : line.words)
+                sum += w++;
+            std::memcpy(ptr, &line, sizeof(Line));
+        }
+    }
+    chr::duration<double> dur = chr::steady_clock::now() - start;
+    if (sum == 1u)
+        std::cerr << "unexpected checksum\n";
+    return {NPASSES * NLINES / dur.count(), {}};
+}
+
+// ------------------------- small vectors ----------------------------------
+
+constexpr size_t NVECTORS = 1'000'000u;
+constexpr int    NELEMS   = 8;
+
+template <typename MakeVector>
+Result RunVectors(MakeVector make_vector) {
+    auto start = chr::steady_clock::now();
+    size_t total = 0u;
+    for (size_t i = 0; i < NVECTORS; i++) {
+        auto vec = make_vector();
+        for (int j = 0; j < NELEMS; j++)
+            vec.push_back(j);
+        total += vec.size();
+    }
+    chr::duration<double> dur = chr::steady_clock::now() - start;
+    if (total != NVECTORS * NELEMS)
+        std::cerr << "unexpected number of elements\n";
+    return {NVECTORS / dur.count(), {}};
+}
+
+void BenchVectors() {
+    PrintRow("vectors", "heap", "fixed", 1u, RunVectors([] { return std::vector<int>(); }));
+    {
+        Allocator arena(1u << 20, Allocator::Growth::Chained);
+        PrintRow("vectors", "arena", "fixed", 1u, RunVectors([&] {
+            return std::vector<int, ArenaAllocator<int>>(ArenaAllocator<int>(arena));
+        }));
+    }
+    {
+        Allocator arena(1u << 20, Allocator::Growth::Chained);
+        ArenaResource res(arena);
+        PrintRow("vectors", "arena_pmr", "fixed", 1u, RunVectors([&] {
+            return std::pmr::vector<int>(&res);
+        }));
+    }
+}
+
+// ------------------------- pointer chasing --------------------------------
+
+struct Node {
+    Node* next;
+    uint64_t value;
+};
+
+constexpr size_t NNODES = 1u << 16;
+constexpr size_t NHOPS  = 1u << 24;
+
+// Every node is followed by a 4KB buffer allocated from the same arena,
+// then the nodes are linked in a random order and the list is traversed.
+template <typename Alloc>
+Result RunChase(Alloc& alloc) {
+    std::vector<Node*> nodes;
+    for (size_t i = 0; i < NNODES; i++) {
+        nodes.push_back(reinterpret_cast<Node*>(alloc.alloc(sizeof(Node))));
+        alloc.alloc(4096u);
+    }
+    std::shuffle(nodes.begin(), nodes.end(), std::mt19937(42));
+    for (size_t i = 0; i < NNODES; i++)
+        *nodes[i] = Node{nodes[(i + 1) % NNODES], i};
+
+    CacheMisses misses;
+    uint64_t sum = 0u;
+    const Node* node = nodes.front();
+    misses.start();
+    auto start = chr::steady_clock::now();
+    for (size_t hop = 0; hop < NHOPS; hop++) {
+        sum += node->value;
+        node = node->next;
+    }
+    chr::duration<double> dur = chr::steady_clock::now() - start;
+    double count = misses.stop();
+    if (sum == 1u)
+        std::cerr << "unexpected checksum\n";
+
+    return {NHOPS / dur.count(), {}, count < 0.0 ? -1.0 : count / NHOPS};
+}
+
+void BenchChase() {
+    const size_t arena_size = NNODES * (4096u + 2 * CACHE_LINE_SIZE) + (64u << 20);
+    {
+        Allocator arena(arena_size);
+        PrintRow("chase", "arena", "mixed", 1u, RunChase(arena));
+    }
+    {
+        Allocator arena(arena_size);
+        SizeClassAllocator sc(arena);
+        PrintRow("chase", "size_classes", "mixed", 1u, RunChase(sc));
+    }
+}
+
+}  // namespace
+
+int main() {
+    std::cout << "benchmark,allocator,distribution,threads,ops_per_sec,p50_ns,p99_ns,p999_ns,misses_per_op\n";
+    BenchAllocs();
+    PrintRow("lines", "unaligned", "fixed", 1u, RunLines(false));
+    PrintRow("lines", "aligned",   "fixed", 1u, RunLines(true));
+    BenchVectors();
+    BenchChase();
+}
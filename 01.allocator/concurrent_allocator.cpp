@@ -0,0 +1,58 @@
+#include <cstdint>
+
+#include "concurrent_allocator.h"
+
+ConcurrentAllocator::ConcurrentAllocator(size_t maxSize) {
+    makeAllocator(maxSize);
+}
+
+void ConcurrentAllocator::makeAllocator(size_t maxSize) {
+    _mem = std::make_unique<char[]>(maxSize);
+    _maxSize = maxSize;
+    _offset.store(0u, std::memory_order_relaxed);
+}
+
+char* ConcurrentAllocator::alloc(size_t size) {
+    size_t offset = _offset.load(std::memory_order_relaxed);
+    do {
+        if (size > _maxSize - offset) {
+            return nullptr;
+        }
+    } while (!_offset.compare_exchange_weak(offset, offset + size,
+                                            std::memory_order_relaxed));
+    return _mem.get() + offset;
+}
+
+char* ConcurrentAllocator::alloc(size_t size, size_t alignment) {
+    if (alignment == 0u || (alignment & (alignment - 1u)) != 0u) {
+        return nullptr;
+    }
+    auto base = reinterpret_cast<uintptr_t>(_mem.get());
+    size_t offset = _offset.load(std::memory_order_relaxed);
+    size_t begin;
+    do {
+        begin = ((base + offset + alignment - 1u) & ~(alignment - 1u)) - base;
+        if (begin > _maxSize || size > _maxSize - begin) {
+            return nullptr;
+        }
+    } while (!_offset.compare_exchange_weak(offset, begin + size,
+                                            std::memory_order_relaxed));
+    return _mem.get() + begin;
+}
+
+char* ConcurrentAllocator::alloc_line(size_t size) {
+    size_t lines = size / CACHE_LINE_SIZE + (size % CACHE_LINE_SIZE != 0u);
+    return alloc(lines * CACHE_LINE_SIZE, CACHE_LINE_SIZE);
+}
+
+size_t ConcurrentAllocator::max_size() const {
+    return _maxSize;
+}
+
+size_t ConcurrentAllocator::used() const {
+    return _offset.load(std::memory_order_relaxed);
+}
+
+void ConcurrentAllocator::reset() {
+    _offset.store(0u, std::memory_order_relaxed);
+}
@@ -0,0 +1,48 @@
+#ifndef MY_CONCURRENT_ALLOCATOR
+#define MY_CONCURRENT_ALLOCATOR
+#include <atomic>
+#include <memory>
+#include <limits>
+
+#include "allocator.h"
+
+// Linear allocator which may be shared between threads.
+// alloc() is lock-free: the offset is bumped with a CAS loop,
+// so concurrent callers always get disjoint blocks.
+// makeAllocator() and reset() are not meant to race with alloc().
+class ConcurrentAllocator {
+ public:
+    ConcurrentAllocator() = default;
+    explicit ConcurrentAllocator(size_t maxSize);
+
+    ConcurrentAllocator(ConcurrentAllocator&) = delete;
+    ConcurrentAllocator& operator=(const ConcurrentAllocator&) = delete;
+
+    ~ConcurrentAllocator() = default;
+
+ public:
+    void makeAllocator(size_t maxSize);
+    char* alloc(size_t size);
+    // alignment must be a power of two, otherwise nullptr is returned
+    char* alloc(size_t size, size_t alignment);
+    // whole cache lines, so that per-thread data is never falsely shared
+    char* alloc_line(size_t size);
+
+    template <class T>
+    T* alloc(size_t n = 1u) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+            return nullptr;
+        return reinterpret_cast<T*>(alloc(n * sizeof(T), alignof(T)));
+    }
+
+    size_t max_size() const;
+    size_t used() const;
+    void reset();
+
+ private:
+    std::unique_ptr<char[]> _mem = nullptr;
+    size_t _maxSize = 0u;
+    std::atomic<size_t> _offset = 0u;
+};
+
+#endif  // MY_CONCURRENT_ALLOCATOR
@@ -1,12 +1,31 @@
 #include <string>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <memory_resource>
+#include <sstream>
 
 #include "allocator.h"
+#include "concurrent_allocator.h"
+#include "arena_resource.h"
+#include "object_pool.h"
+#include "size_class_allocator.h"
 #include "test_runner.h"
 
 void TestMakeAlloc();
 void TestAlloc();
 void TestReset();
 void TestUsage();
+void TestConcurrentAlloc();
+void TestAlignedAlloc();
+void TestChainedAlloc();
+void TestRewind();
+void TestArenaResource();
+void TestMappedBacking();
+void TestObjectPool();
+void TestStats();
+void TestSizeClasses();
 
 void TestMakeAlloc() {
     {
@@ -90,6 +109,431 @@ void TestUsage() {
     ASSERT(std::string(a.alloc(7)) == std::string("sphere"));
 }
 
+void TestConcurrentAlloc() {
+    {
+        ConcurrentAllocator a(10);
+        ASSERT(a.alloc(6) != nullptr);
+        ASSERT(a.alloc(6) == nullptr);
+        ASSERT(a.alloc(4) != nullptr);
+        ASSERT_EQUAL(a.used(), 10u);
+
+        a.reset();
+        ASSERT_EQUAL(a.used(), 0u);
+        ASSERT(a.alloc(10) != nullptr);
+    }
+    {
+        const size_t nthreads = 8u;
+        const size_t nallocs  = 1000u;
+        ConcurrentAllocator a(nthreads * nallocs);
+
+        std::vector<std::vector<char*>> ptrs(nthreads);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < nthreads; t++) {
+            threads.emplace_back([&, t] {
+                for (size_t i = 0; i < nallocs; i++) {
+                    char* ptr = a.alloc(1);
+                    *ptr = static_cast<char>(t);
+                    ptrs[t].push_back(ptr);
+                }
+            });
+        }
+        for (auto& thr : threads)
+            thr.join();
+
+        ASSERT(a.alloc(1) == nullptr);
+        for (size_t t = 0; t < nthreads; t++)
+            ASSERT(std::all_of(ptrs[t].begin(), ptrs[t].end(),
+                               [t](char* ptr) { return *ptr == static_cast<char>(t); }));
+
+        a.reset();
+        ASSERT(a.alloc(nthreads * nallocs) != nullptr);
+    }
+}
+
+namespace {
+
+bool IsAligned(const void* ptr, size_t alignment) {
+    return reinterpret_cast<uintptr_t>(ptr) % alignment == 0u;
+}
+
+}  // namespace
+
+void TestAlignedAlloc() {
+    {
+        Allocator a(256);
+        ASSERT(a.alloc(1) != nullptr);
+
+        uint64_t* num = a.alloc<uint64_t>();
+        ASSERT(num != nullptr && IsAligned(num, alignof(uint64_t)));
+
+        ASSERT(a.alloc(1) != nullptr);
+        char* ptr = a.alloc(8, 32);
+        ASSERT(ptr != nullptr && IsAligned(ptr, 32));
+
+        ASSERT(a.alloc(1, 3) == nullptr);
+        ASSERT(a.alloc(1, 0) == nullptr);
+        ASSERT(a.alloc<uint64_t>(~0ul) == nullptr);
+    }
+    {
+        Allocator a(2 * CACHE_LINE_SIZE);
+        char* first = a.alloc_line(1);
+        ASSERT(first != nullptr && IsAligned(first, CACHE_LINE_SIZE));
+        char* second = a.alloc(1);
+        ASSERT(second == first + CACHE_LINE_SIZE);
+    }
+    {
+        Allocator a(8);
+        ASSERT(a.alloc(1) != nullptr);
+        ASSERT(a.alloc<uint64_t>() == nullptr);
+    }
+    {
+        ConcurrentAllocator a(256);
+        ASSERT(a.alloc(1) != nullptr);
+
+        uint64_t* num = a.alloc<uint64_t>(2);
+        ASSERT(num != nullptr && IsAligned(num, alignof(uint64_t)));
+
+        char* line = a.alloc_line(CACHE_LINE_SIZE + 1);
+        ASSERT(line != nullptr && IsAligned(line, CACHE_LINE_SIZE));
+        ASSERT(a.alloc(1, 3) == nullptr);
+    }
+}
+
+void TestChainedAlloc() {
+    {
+        Allocator a(16, Allocator::Growth::Chained);
+        ASSERT_EQUAL(a.block_count(), 1u);
+
+        ASSERT(a.alloc(10) != nullptr);
+        char* ptr = a.alloc(10);
+        ASSERT(ptr != nullptr);
+        ASSERT_EQUAL(a.block_count(), 2u);
+
+        ptr = a.alloc(100);
+        ASSERT(ptr != nullptr);
+        ASSERT_EQUAL(a.block_count(), 3u);
+        ASSERT_EQUAL(a.high_water_mark(), 120u);
+
+        a.reset();
+        ASSERT_EQUAL(a.block_count(), 1u);
+        ASSERT_EQUAL(a.high_water_mark(), 120u);
+        ASSERT_EQUAL(a.max_size(), 16u);
+
+        ASSERT(a.alloc(100) == ptr);
+        ASSERT_EQUAL(a.block_count(), 1u);
+    }
+    {
+        Allocator a(0, Allocator::Growth::Chained);
+        uint64_t* num = a.alloc<uint64_t>(3);
+        ASSERT(num != nullptr && IsAligned(num, alignof(uint64_t)));
+        ASSERT_EQUAL(a.block_count(), 2u);
+    }
+    {
+        Allocator a(16);
+        ASSERT(a.alloc(10) != nullptr);
+        ASSERT(a.alloc(10) == nullptr);
+        ASSERT_EQUAL(a.block_count(), 1u);
+        ASSERT_EQUAL(a.high_water_mark(), 10u);
+    }
+}
+
+void TestRewind() {
+    {
+        Allocator a(20);
+        char* first = a.alloc(5);
+        auto marker = a.mark();
+        char* second = a.alloc(10);
+        ASSERT(a.alloc(10) == nullptr);
+
+        a.rewind(marker);
+        ASSERT(a.alloc(10) == second);
+        ASSERT(a.alloc(5) != nullptr);
+
+        a.rewind(a.mark());
+        ASSERT(a.alloc(1) == nullptr);
+        ASSERT(first != nullptr);
+    }
+    {
+        Allocator a(16);
+        ASSERT(a.alloc(4) != nullptr);
+        {
+            Allocator::Scope outer(a);
+            char* ptr = a.alloc(4);
+            {
+                Allocator::Scope inner(a);
+                ASSERT(a.alloc(8) != nullptr);
+                ASSERT(a.alloc(1) == nullptr);
+            }
+            ASSERT(a.alloc(8) == ptr + 4);
+        }
+        ASSERT(a.alloc(12) != nullptr);
+        ASSERT_EQUAL(a.high_water_mark(), 16u);
+    }
+    {
+        Allocator a(8, Allocator::Growth::Chained);
+        auto marker = a.mark();
+        ASSERT(a.alloc(8) != nullptr);
+        char* big = a.alloc(100);
+        ASSERT_EQUAL(a.block_count(), 2u);
+
+        a.rewind(marker);
+        ASSERT(a.alloc(8) != nullptr);
+        ASSERT(a.alloc(100) == big);
+        ASSERT_EQUAL(a.block_count(), 2u);
+        ASSERT_EQUAL(a.high_water_mark(), 108u);
+    }
+    {
+        // a cached block too small for the request does not drop the larger ones
+        Allocator a(8, Allocator::Growth::Chained);
+        auto marker = a.mark();
+        ASSERT(a.alloc(8) != nullptr);
+        char* small = a.alloc(16);
+        char* big = a.alloc(100);
+        ASSERT_EQUAL(a.block_count(), 3u);
+
+        a.rewind(marker);
+        ASSERT(a.alloc(8) != nullptr);
+        ASSERT(a.alloc(100) == big);
+        ASSERT(a.alloc(16) == small);
+        ASSERT_EQUAL(a.block_count(), 3u);
+
+        a.rewind(marker);
+        ASSERT(a.alloc(8) != nullptr);
+        ASSERT(a.alloc(200) != nullptr);
+        ASSERT_EQUAL(a.block_count(), 4u);
+        ASSERT(a.alloc(100) == big);
+        ASSERT_EQUAL(a.block_count(), 4u);
+
+        a.reset();
+        ASSERT_EQUAL(a.block_count(), 1u);
+        ASSERT(a.alloc(200) != nullptr);
+        ASSERT_EQUAL(a.block_count(), 1u);
+    }
+    {
+        Allocator a;
+        a.rewind(a.mark());
+        ASSERT(a.alloc(1) == nullptr);
+    }
+}
+
+void TestArenaResource() {
+    {
+        Allocator a(1024);
+        ArenaResource res(a);
+        std::pmr::vector<uint64_t> nums(&res);
+        for (uint64_t i = 0; i < 10; i++)
+            nums.push_back(i);
+        ASSERT_EQUAL(nums.back(), 9u);
+        ASSERT(IsAligned(nums.data(), alignof(uint64_t)));
+        ASSERT(a.high_water_mark() > 10 * sizeof(uint64_t));
+
+        size_t used = a.high_water_mark();
+        std::pmr::string str("a string which does not fit into SSO buffer", &res);
+        ASSERT(a.high_water_mark() > used + str.size());
+
+        ArenaResource same(a);
+        ASSERT(res.is_equal(same));
+        ASSERT(!res.is_equal(*std::pmr::new_delete_resource()));
+    }
+    {
+        Allocator a(16);
+        ArenaResource res(a);
+        try {
+            std::pmr::vector<char> chars(32, 'a', &res);
+            ASSERT(false);
+        } catch (std::bad_alloc&) {
+            ASSERT(true);
+        }
+    }
+    {
+        Allocator a(256);
+        std::vector<int, ArenaAllocator<int>> ints({1, 2, 3}, ArenaAllocator<int>(a));
+        ints.push_back(4);
+        ASSERT_EQUAL(ints.size(), 4u);
+        ASSERT(a.high_water_mark() >= 7 * sizeof(int));
+
+        ArenaAllocator<char> chars(ints.get_allocator());
+        ASSERT(chars == ints.get_allocator());
+
+        Allocator b(256);
+        ASSERT(chars != ArenaAllocator<int>(b));
+    }
+}
+
+void TestMappedBacking() {
+    for (auto backing : {Allocator::Backing::Mmap, Allocator::Backing::HugePages}) {
+        const size_t size = 1u << 20;
+        Allocator a(size, Allocator::Growth::Fixed, backing);
+        char* ptr = a.alloc(size);
+        ASSERT(ptr != nullptr);
+        std::fill_n(ptr, size, 'x');
+        ASSERT(a.alloc(1) == nullptr);
+        a.reset();
+
+        ASSERT(a.alloc(10) == ptr);
+        a.reset(true);
+
+        ptr = a.alloc(size);
+        ASSERT_EQUAL(ptr[0], 'x');
+        if (backing == Allocator::Backing::Mmap)
+            ASSERT_EQUAL(ptr[size - 1], '\0');
+    }
+    {
+        Allocator a(16, Allocator::Growth::Chained, Allocator::Backing::Mmap);
+        ASSERT(a.alloc(10) != nullptr);
+        ASSERT(a.alloc(100) != nullptr);
+        ASSERT_EQUAL(a.block_count(), 2u);
+        a.reset(true);
+        ASSERT_EQUAL(a.block_count(), 1u);
+        ASSERT_EQUAL(a.high_water_mark(), 110u);
+    }
+    {
+        // no mapping that large: the chained block fails like a full Fixed arena
+        Allocator a(16, Allocator::Growth::Chained, Allocator::Backing::Mmap);
+        char* ptr = a.alloc(10);
+        ASSERT(ptr != nullptr);
+        ASSERT(a.alloc(size_t{1} << 62) == nullptr);
+        ASSERT_EQUAL(a.block_count(), 1u);
+#ifdef ALLOCATOR_STATS
+        ASSERT_EQUAL(a.stats().failures, 1u);
+#endif
+        ASSERT(a.alloc(6) == ptr + 10);
+    }
+}
+
+namespace {
+
+struct TreeNode {
+    int v;
+    TreeNode* left = nullptr;
+    TreeNode* right = nullptr;
+};
+
+TreeNode* SortedArrayToBST(ObjectPool<TreeNode>& pool, const int* begin, const int* end) {
+    if (begin == end)
+        return nullptr;
+    const int* mid = begin + (end - begin) / 2;
+    return pool.create(TreeNode{*mid,
+                                SortedArrayToBST(pool, begin, mid),
+                                SortedArrayToBST(pool, mid + 1, end)});
+}
+
+void DestroyTree(ObjectPool<TreeNode>& pool, TreeNode* node) {
+    if (node == nullptr)
+        return;
+    DestroyTree(pool, node->left);
+    DestroyTree(pool, node->right);
+    pool.destroy(node);
+}
+
+}  // namespace
+
+void TestObjectPool() {
+    {
+        Allocator a(1024);
+        ObjectPool<uint64_t> pool(a, 4);
+        uint64_t* first = pool.create(1u);
+        uint64_t* second = pool.create(2u);
+        ASSERT(IsAligned(first, alignof(uint64_t)));
+        ASSERT(second == first + 1);
+        ASSERT_EQUAL(pool.size(), 2u);
+
+        pool.destroy(first);
+        ASSERT(pool.create(3u) == first);
+        ASSERT_EQUAL(*first, 3u);
+        ASSERT_EQUAL(a.high_water_mark(), 4 * sizeof(uint64_t));
+    }
+    {
+        Allocator a(4096, Allocator::Growth::Chained);
+        ObjectPool<TreeNode> pool(a);
+        std::vector<int> nums(100);
+        for (int i = 0; i < 100; i++)
+            nums[i] = i;
+
+        TreeNode* root = SortedArrayToBST(pool, nums.data(), nums.data() + nums.size());
+        ASSERT_EQUAL(root->v, 50);
+        ASSERT_EQUAL(pool.size(), 100u);
+        size_t used = a.high_water_mark();
+
+        DestroyTree(pool, root);
+        ASSERT_EQUAL(pool.size(), 0u);
+        root = SortedArrayToBST(pool, nums.data(), nums.data() + nums.size());
+        ASSERT_EQUAL(root->left->v, 25);
+        ASSERT_EQUAL(a.high_water_mark(), used);
+    }
+    {
+        Allocator a(sizeof(uint64_t));
+        ObjectPool<uint64_t> pool(a, 2);
+        try {
+            pool.create(0u);
+            ASSERT(false);
+        } catch (std::bad_alloc&) {
+            ASSERT(true);
+        }
+    }
+}
+
+void TestStats() {
+    Allocator a(64, Allocator::Growth::Chained);
+    ASSERT(a.alloc(1) != nullptr);
+    ASSERT(a.alloc<uint64_t>() != nullptr);
+    ASSERT(a.alloc(1, 3) == nullptr);
+    ASSERT(a.alloc(100) != nullptr);
+
+    auto stats = a.stats();
+    ASSERT_EQUAL(stats.in_use, 116u);
+    ASSERT_EQUAL(stats.peak, 116u);
+    ASSERT_EQUAL(stats.capacity, 64u + 128u);
+    ASSERT_EQUAL(stats.blocks, 2u);
+#ifdef ALLOCATOR_STATS
+    ASSERT_EQUAL(stats.allocations, 3u);
+    ASSERT_EQUAL(stats.failures, 1u);
+    ASSERT_EQUAL(stats.padding, 7u);
+#else
+    ASSERT_EQUAL(stats.allocations + stats.failures + stats.padding, 0u);
+#endif
+
+    a.reset();
+    stats = a.stats();
+    ASSERT_EQUAL(stats.in_use, 0u);
+    ASSERT_EQUAL(stats.peak, 116u);
+
+    std::ostringstream os;
+    os << stats;
+    std::string prefix = "{\"in_use\": 0, \"peak\": 116, \"capacity\": 128, \"blocks\": 1, ";
+    ASSERT_EQUAL(os.str().substr(0, prefix.size()), prefix);
+    ASSERT_EQUAL(os.str().back(), '}');
+}
+
+void TestSizeClasses() {
+    ASSERT_EQUAL(SizeClassAllocator::class_of(1), 0u);
+    ASSERT_EQUAL(SizeClassAllocator::class_of(16), 0u);
+    ASSERT_EQUAL(SizeClassAllocator::class_of(17), 1u);
+    ASSERT_EQUAL(SizeClassAllocator::class_of(4096), SizeClassAllocator::NCLASSES - 1);
+    {
+        Allocator a(1u << 20);
+        SizeClassAllocator sc(a, 4096);
+        char* small = sc.alloc(10);
+        char* big = sc.alloc(4000);
+        char* small2 = sc.alloc(16);
+        char* mid = sc.alloc(33);
+        char* huge = sc.alloc(5000);
+        ASSERT(small != nullptr && big != nullptr && mid != nullptr && huge != nullptr);
+        ASSERT(small2 == small + 16);
+        ASSERT(IsAligned(small, CACHE_LINE_SIZE) && IsAligned(mid, 64));
+        ASSERT(sc.alloc(64) == mid + 64);
+
+        a.reset();
+        sc.reset();
+        ASSERT(sc.alloc(1) != nullptr);
+    }
+    {
+        Allocator a(1024);
+        SizeClassAllocator sc(a);
+        ASSERT(sc.alloc(8) == nullptr);
+        ASSERT(sc.alloc(8) == nullptr);
+    }
+}
 
 int main() {
     TestRunner tr;
@@ -97,4 +541,13 @@ int main() {
     RUN_TEST(tr, TestAlloc);
     RUN_TEST(tr, TestReset);
     RUN_TEST(tr, TestUsage);
+    RUN_TEST(tr, TestConcurrentAlloc);
+    RUN_TEST(tr, TestAlignedAlloc);
+    RUN_TEST(tr, TestChainedAlloc);
+    RUN_TEST(tr, TestRewind);
+    RUN_TEST(tr, TestArenaResource);
+    RUN_TEST(tr, TestMappedBacking);
+    RUN_TEST(tr, TestObjectPool);
+    RUN_TEST(tr, TestStats);
+    RUN_TEST(tr, TestSizeClasses);
 }
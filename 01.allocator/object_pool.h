@@ -0,0 +1,84 @@
+#ifndef MY_OBJECT_POOL
+#define MY_OBJECT_POOL
+#include <new>
+#include <utility>
+
+#include "allocator.h"
+
+// Pool of same-size objects carved out of an arena in slabs.
+// create() and destroy() are O(1): freed slots go to an intrusive free list
+// and are handed out before the current slab is bumped further.
+// The slabs are owned by the arena, so the pool must not outlive it
+// or be used after the arena is reset below them.
+// Like Allocator, a pool is meant to be owned by a single thread.
+template <typename T>
+class ObjectPool {
+ public:
+    explicit ObjectPool(Allocator& arena, size_t slab_size = 64u)
+        : _arena(arena), _slabSize(slab_size == 0u ? 1u : slab_size) {}
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    ~ObjectPool() = default;
+
+ public:
+    template <typename... Args>
+    T* create(Args&&... args) {
+        Slot* slot = take();
+        try {
+            T* ptr = ::new (static_cast<void*>(slot->storage)) T(std::forward<Args>(args)...);
+            _size++;
+            return ptr;
+        } catch (...) {
+            put(slot);
+            throw;
+        }
+    }
+
+    void destroy(T* ptr) noexcept {
+        if (ptr == nullptr)
+            return;
+        ptr->~T();
+        put(reinterpret_cast<Slot*>(ptr));
+        _size--;
+    }
+
+    // number of live objects
+    size_t size() const noexcept { return _size; }
+
+ private:
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    Slot* take() {
+        if (_free != nullptr) {
+            return std::exchange(_free, _free->next);
+        }
+        if (_slab == _slabEnd) {
+            _slab = _arena.alloc<Slot>(_slabSize);
+            if (_slab == nullptr)
+                throw std::bad_alloc();
+            _slabEnd = _slab + _slabSize;
+        }
+        return _slab++;
+    }
+
+    void put(Slot* slot) noexcept {
+        slot->next = _free;
+        _free = slot;
+    }
+
+ private:
+    Allocator& _arena;
+    size_t _slabSize;
+    size_t _size = 0u;
+
+    Slot* _free = nullptr;
+    Slot* _slab = nullptr;
+    Slot* _slabEnd = nullptr;
+};
+
+#endif  // MY_OBJECT_POOL
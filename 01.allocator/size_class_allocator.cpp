@@ -0,0 +1,38 @@
+#include <algorithm>
+
+#include "size_class_allocator.h"
+
+SizeClassAllocator::SizeClassAllocator(Allocator& arena, size_t region_size)
+    : _arena(arena)
+    , _regionSize(std::max(region_size, MAX_CLASS)) {}
+
+size_t SizeClassAllocator::class_of(size_t size) {
+    size_t cls = 0u;
+    for (size_t cls_size = MIN_CLASS; cls_size < size; cls_size *= 2)
+        cls++;
+    return cls;
+}
+
+char* SizeClassAllocator::alloc(size_t size) {
+    if (size > MAX_CLASS) {
+        return _arena.alloc(size, CACHE_LINE_SIZE);
+    }
+    size_t cls = class_of(size);
+    size_t cls_size = MIN_CLASS << cls;
+    Region& region = _regions[cls];
+    if (region.offset == region.end) {
+        region.offset = _arena.alloc(_regionSize - _regionSize % cls_size, CACHE_LINE_SIZE);
+        if (region.offset == nullptr) {
+            region.end = nullptr;
+            return nullptr;
+        }
+        region.end = region.offset + _regionSize - _regionSize % cls_size;
+    }
+    char* ptr = region.offset;
+    region.offset += cls_size;
+    return ptr;
+}
+
+void SizeClassAllocator::reset() {
+    _regions.fill({});
+}
@@ -0,0 +1,44 @@
+#ifndef MY_SIZE_CLASS_ALLOCATOR
+#define MY_SIZE_CLASS_ALLOCATOR
+#include <array>
+
+#include "allocator.h"
+
+// Segregates allocations by size: every power-of-two class from
+// MIN_CLASS to MAX_CLASS bumps in its own region carved out of the arena,
+// so small objects stay densely packed even when interleaved with large ones.
+// Larger requests go straight to the arena.
+// Regions belong to the arena: call reset() whenever the arena is reset.
+class SizeClassAllocator {
+ public:
+    static constexpr size_t MIN_CLASS = 16u;
+    static constexpr size_t MAX_CLASS = 4096u;
+    static constexpr size_t NCLASSES  = 9u;
+
+ public:
+    explicit SizeClassAllocator(Allocator& arena, size_t region_size = 64u * 1024u);
+
+    SizeClassAllocator(const SizeClassAllocator&) = delete;
+    SizeClassAllocator& operator=(const SizeClassAllocator&) = delete;
+
+    ~SizeClassAllocator() = default;
+
+ public:
+    // aligned to the class size, but not more than CACHE_LINE_SIZE
+    char* alloc(size_t size);
+    void reset();
+
+    static size_t class_of(size_t size);
+
+ private:
+    struct Region {
+        char* offset = nullptr;
+        char* end = nullptr;
+    };
+
+    Allocator& _arena;
+    size_t _regionSize;
+    std::array<Region, NCLASSES> _regions;
+};
+
+#endif  // MY_SIZE_CLASS_ALLOCATOR
@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <istream>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parallel.h"
+#include "parser.h"
+#include "scanner.h"
+#include "stream.h"
+
+namespace chr = std::chrono;
+
+// Every benchmark prints CSV rows of the form
+// benchmark,corpus,bytes,tokens,tokens_per_sec,bytes_per_sec
+// for each corpus kind and size up to the one given on the command line
+// (16M by default, K/M/G suffixes). Sizes grow 8x from 4K.
+
+namespace {
+
+constexpr size_t UNIQUE_SIZE = 16u << 20;
+constexpr size_t MIN_PASSES = 3u;
+constexpr double MIN_SECONDS = 0.2;
+
+// keeps results that are not printed from being optimized out
+volatile uint64_t sink;
+
+struct CorpusKind {
+    std::string name;
+    int numbers_per_10;
+    int min_len, max_len;
+    // spaces between tokens, 1 means a single space or newline
+    int max_spaces;
+    char separator;
+};
+
+const CorpusKind CORPORA[] = {
+    {"numeric",    10, 1, 19, 1, ' '},
+    {"string",     0,  1, 16, 1, ' '},
+    {"mixed",      5,  1, 16, 1, ' '},
+    {"mixed80",    8,  1, 16, 1, ' '},
+    {"long",       5,  64, 4096, 1, ' '},
+    {"whitespace", 5,  1, 8, 32, ' '},
+    {"csv",        5,  1, 16, 1, ','},
+};
+
+// Tokens of kind.min_len to kind.max_len characters, numbers_per_10 of every
+// 10 of them numbers. The first UNIQUE_SIZE bytes are random and repeated
+// up to size, so GB corpora are quick to build.
+std::string MakeCorpus(const CorpusKind& kind, size_t size) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> len(kind.min_len, kind.max_len);
+    std::uniform_int_distribution<int> digit('0', '9');
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<int> nspaces(1, kind.max_spaces);
+    const std::string spaces = " \t\n\v\f\r";
+    std::uniform_int_distribution<size_t> space(0, spaces.size() - 1);
+    std::string corpus;
+    corpus.reserve(size + kind.max_len + kind.max_spaces);
+    for (size_t i = 0; corpus.size() < std::min(size, UNIQUE_SIZE); i++) {
+        bool number = static_cast<int>(i % 10) < kind.numbers_per_10;
+        for (int j = len(gen); j > 0; j--)
+            corpus += static_cast<char>(number ? digit(gen) : letter(gen));
+        if (kind.max_spaces == 1) {
+            corpus += i % 16 == 15 ? '\n' : kind.separator;
+        } else {
+            // the last one is a delimiter, so the token ends even on '\v'
+            for (int j = nspaces(gen); j > 1; j--)
+                corpus += spaces[space(gen)];
+            corpus += '\t';
+        }
+    }
+    const size_t unique = corpus.size();
+    while (corpus.size() < size)
+        corpus.append(corpus, 0, std::min(unique, size - corpus.size()));
+    corpus.resize(size);
+    return corpus;
+}
+
+// "64M" -> 64 << 20
+size_t ParseSize(const std::string& str) {
+    size_t pos = 0u;
+    size_t size = std::stoull(str, &pos);
+    switch (pos < str.size() ? std::toupper(str[pos]) : 0) {
+        case 'G': return size << 30;
+        case 'M': return size << 20;
+        case 'K': return size << 10;
+        default:  return size;
+    }
+}
+
+std::string SizeName(size_t size) {
+    if (size >= (1u << 30)) return std::to_string(size >> 30) + "G";
+    if (size >= (1u << 20)) return std::to_string(size >> 20) + "M";
+    return std::to_string(size >> 10) + "K";
+}
+
+// reads a string without copying it, for the istream driver
+class ViewBuf : public std::streambuf {
+ public:
+    explicit ViewBuf(std::string_view sv) {
+        char* p = const_cast<char*>(sv.data());
+        setg(p, p, p + sv.size());
+    }
+};
+
+// TokenParser::run before the vectorized scanner
+size_t LegacyScan(std::string_view sv) {
+    size_t ntokens = 0u;
+    while (!sv.empty()) {
+        while (!sv.empty() && std::isspace(sv[0]))
+            sv.remove_prefix(1);
+        auto pos = sv.find_first_of(" \t\n");
+        ntokens += pos != 0u && !sv.empty();
+        sv.remove_prefix(pos != sv.npos ? pos : sv.size());
+    }
+    return ntokens;
+}
+
+template <typename SkipSpaces, typename FindDelimiter>
+size_t Scan(std::string_view sv, SkipSpaces skip, FindDelimiter find) {
+    size_t ntokens = 0u;
+    const char* end = sv.data() + sv.size();
+    for (const char* pos = skip(sv.data(), end); pos != end; pos = skip(pos, end)) {
+        pos = find(pos, end);
+        ntokens++;
+    }
+    return ntokens;
+}
+
+struct Benchmark {
+    std::string name;
+    // run on the csv corpus only, or on all the others
+    bool csv;
+    std::function<size_t(std::string_view)> run;
+};
+
+// Best of at least MIN_PASSES runs and MIN_SECONDS.
+void Run(const Benchmark& bench, const std::string& corpus_name, std::string_view corpus) {
+    size_t ntokens = 0u;
+    double best = 0.0;
+    chr::duration<double> total{0.0};
+    for (size_t pass = 0; pass < MIN_PASSES || total.count() < MIN_SECONDS; pass++) {
+        auto start = chr::steady_clock::now();
+        ntokens = bench.run(corpus);
+        chr::duration<double> dur = chr::steady_clock::now() - start;
+        total += dur;
+        if (pass == 0u || dur.count() < best)
+            best = dur.count();
+    }
+    std::cout << bench.name << ',' << corpus_name << ',' << corpus.size() << ','
+              << ntokens << ',' << static_cast<uint64_t>(ntokens / best) << ','
+              << static_cast<uint64_t>(corpus.size() / best) << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t max_size = ParseSize(argc > 1 ? argv[1] : "16M");
+    std::vector<Benchmark> benchmarks;
+    auto add = [&](std::string name, auto run, bool csv = false) {
+        benchmarks.push_back({std::move(name), csv, std::move(run)});
+    };
+
+    add("legacy scan", LegacyScan);
+    add("scalar scan", [](std::string_view sv) {
+        return Scan(sv, scanner::scalar::SkipSpaces<>, scanner::scalar::FindDelimiter<>);
+    });
+    add("simd scan", [](std::string_view sv) {
+        return Scan(sv, scanner::SkipSpaces<>, scanner::FindDelimiter<>);
+    });
+    add("simd bitmask scan", [](std::string_view sv) {
+        scanner::Scanner scan(sv.data(), sv.data() + sv.size());
+        return Scan(sv, [&](const char* p, const char*) { return scan.skip_spaces(p); },
+                        [&](const char* p, const char*) { return scan.find_delimiter(p); });
+    });
+
+    size_t ntokens = 0u;
+    TokenParser tp;
+    tp.set_number_callback([&](uint64_t) { ntokens++; });
+    tp.set_string_callback([&](const std::string&) { ntokens++; });
+    TokenParser tp_view;
+    tp_view.set_number_callback([&](uint64_t) { ntokens++; });
+    tp_view.set_string_view_callback([&](std::string_view) { ntokens++; });
+    add("TokenParser::run", [&](std::string_view sv) {
+        ntokens = 0u;
+        tp.run(sv);
+        return ntokens;
+    });
+    add("TokenParser::run (string_view)", [&](std::string_view sv) {
+        ntokens = 0u;
+        tp_view.run(sv);
+        return ntokens;
+    });
+
+    BasicTokenParser basic([&] { ntokens = 0u; },
+                           [&](uint64_t) { ntokens++; },
+                           [&](std::string_view) { ntokens++; },
+                           NoCallback{});
+    add("BasicTokenParser::run", [&](std::string_view sv) {
+        basic.run(sv);
+        return ntokens;
+    });
+    BasicTokenParser csv_parser([&] { ntokens = 0u; },
+                                [&](uint64_t) { ntokens++; },
+                                [&](std::string_view) { ntokens++; },
+                                NoCallback{}, TokenSyntax<scanner::DelimiterSet<',', '\n'>>{});
+    add("BasicTokenParser::run (csv delimiters)", [&](std::string_view sv) {
+        csv_parser.run(sv);
+        return ntokens;
+    }, true);
+    add("TokenBatcher (4096 records) + sum", [](std::string_view sv) {
+        constexpr size_t CAPACITY = 4096u;
+        static TokenKind kinds[CAPACITY];
+        static size_t offsets[CAPACITY], lengths[CAPACITY];
+        static uint64_t values[CAPACITY];
+        const TokenBatch batch{kinds, offsets, lengths, values, CAPACITY};
+        TokenBatcher batcher(sv);
+        size_t ntokens = 0u;
+        uint64_t sum = 0u;
+        while (size_t count = batcher.next(batch)) {
+            for (size_t i = 0; i < count; i++)
+                sum += values[i];
+            ntokens += count;
+        }
+        sink = sum;
+        return ntokens;
+    });
+    add("TokenStream::feed (4 KB chunks)", [&](std::string_view sv) {
+        TokenStream stream(basic);
+        for (size_t pos = 0; pos < sv.size(); pos += 4096u)
+            stream.feed(sv.substr(pos, 4096u));
+        stream.finish();
+        return ntokens;
+    });
+    add("ParseStream (istream, 1 MB chunks)", [&](std::string_view sv) {
+        ViewBuf buf(sv);
+        std::istream input(&buf);
+        ParseStream(basic, input);
+        return ntokens;
+    });
+
+    const unsigned nthreads = std::thread::hardware_concurrency();
+    ThreadPool pool(nthreads);
+    add("ParseParallel (sequential)", [&](std::string_view sv) {
+        ParseParallel(basic, sv, pool, 4u * nthreads);
+        return ntokens;
+    });
+    std::atomic<size_t> counter = 0u;
+    BasicTokenParser shared([&] { counter = 0u; },
+                            [&](uint64_t) { counter.fetch_add(1u, std::memory_order_relaxed); },
+                            [&](std::string_view) { counter.fetch_add(1u, std::memory_order_relaxed); },
+                            NoCallback{});
+    add("ParseParallel (unordered)", [&](std::string_view sv) {
+        ParseParallel(shared, sv, pool, 4u * nthreads, ParseOrder::UNORDERED);
+        return counter.load();
+    });
+
+    std::cout << "benchmark,corpus,bytes,tokens,tokens_per_sec,bytes_per_sec\n";
+    for (size_t size = 4u << 10; size <= max_size; size *= 8u) {
+        for (const CorpusKind& kind : CORPORA) {
+            const std::string corpus = MakeCorpus(kind, size);
+            const std::string name = kind.name + "/" + SizeName(size);
+            for (const Benchmark& bench : benchmarks) {
+                if (bench.csv == (kind.separator == ','))
+                    Run(bench, name, corpus);
+            }
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef TOKEN_PARALLEL_H
+#define TOKEN_PARALLEL_H
+
+#include <string_view>
+#include <vector>
+
+#include "ThreadPool.h"
+#include "scanner.h"
+
+enum class ParseOrder {
+    // callbacks are invoked on the calling thread in input order
+    SEQUENTIAL,
+    // callbacks are invoked on the pool threads as chunks are parsed,
+    // they must be thread-safe
+    UNORDERED
+};
+
+// Splits sv into at most n pieces of about equal size. Every piece but the
+// first starts right after a delimiter, so no token is cut and parsing the
+// pieces one after another gives the same tokens as parsing sv.
+template<class Delims = scanner::DefaultDelimiters>
+std::vector<std::string_view> SplitChunks(std::string_view sv, size_t n);
+
+// Parses sv in n chunks on the pool. The start and end callbacks are called
+// once on the calling thread. In SEQUENTIAL mode each chunk is parsed into a
+// token list and the lists are replayed in order while later chunks are
+// still parsed. With an empty pool sv is parsed on the calling thread.
+template<class Parser>
+void ParseParallel(Parser& parser, std::string_view sv, ThreadPool& pool,
+                   size_t n, ParseOrder order = ParseOrder::SEQUENTIAL);
+
+#include "parallel.tcc"
+
+#endif  // TOKEN_PARALLEL_H
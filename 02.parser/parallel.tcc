@@ -0,0 +1,119 @@
+#ifndef TOKEN_PARALLEL_TCC
+#define TOKEN_PARALLEL_TCC
+
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <variant>
+
+#include "parallel.h"
+#include "parser.h"
+#include "scanner.h"
+
+template<class Delims>
+std::vector<std::string_view> SplitChunks(std::string_view sv, size_t n) {
+    std::vector<std::string_view> chunks;
+    if (n == 0u)
+        n = 1u;
+    const char* begin = sv.data();
+    const char* end = begin + sv.size();
+    const size_t step = sv.size() / n;
+    while (begin != end) {
+        const char* cut = end;
+        if (chunks.size() + 1u < n && static_cast<size_t>(end - begin) > step) {
+            cut = scanner::FindDelimiter<Delims>(begin + step, end);
+            if (cut != end)
+                ++cut;
+        }
+        chunks.emplace_back(begin, cut - begin);
+        begin = cut;
+    }
+    return chunks;
+}
+
+namespace parallel_detail {
+
+using Token = std::variant<uint64_t, int64_t, double, std::string_view>;
+
+// Waits for the futures not taken yet
+template<class Future>
+void WaitAll(const std::vector<Future>& futures) {
+    for (const auto& f : futures) {
+        if (f.valid())
+            f.wait();
+    }
+}
+
+template<class Parser>
+std::vector<Token> Tokenize(const Parser& parser, std::string_view chunk) {
+    std::vector<Token> tokens;
+    parser.tokenize(chunk,
+                    [&tokens](auto num) { tokens.emplace_back(num); },
+                    [&tokens](std::string_view s) { tokens.emplace_back(s); });
+    return tokens;
+}
+
+template<class Parser, class Number>
+void Replay(Parser& parser, Number num) {
+    parser.number(num);
+}
+
+template<class Parser>
+void Replay(Parser& parser, std::string_view token) {
+    parser.string(token);
+}
+
+}  // namespace parallel_detail
+
+template<class Parser>
+void ParseParallel(Parser& parser, std::string_view sv, ThreadPool& pool,
+                   size_t n, ParseOrder order) {
+    // an empty pool (hardware_concurrency() may be 0) leaves it all to this thread
+    if (pool.size() == 0u) {
+        parser.run(sv);
+        return;
+    }
+    parser.start();
+    const std::vector<std::string_view> chunks =
+        SplitChunks<typename Parser::Delimiters>(sv, n);
+    // the tasks use parser and sv, so all of them finish before anything
+    // is thrown, be it from a task, exec() or a callback on this thread
+    std::exception_ptr error;
+    if (order == ParseOrder::UNORDERED) {
+        std::vector<std::future<void>> done;
+        done.reserve(chunks.size());
+        try {
+            for (std::string_view chunk : chunks)
+                done.push_back(pool.exec([&parser, chunk] { parser.run_tokens(chunk); }));
+        } catch (...) {
+            error = std::current_exception();
+        }
+        parallel_detail::WaitAll(done);
+        if (error)
+            std::rethrow_exception(error);
+        for (auto& f : done)
+            f.get();
+    } else {
+        std::vector<std::future<std::vector<parallel_detail::Token>>> parsed;
+        parsed.reserve(chunks.size());
+        try {
+            for (std::string_view chunk : chunks)
+                parsed.push_back(pool.exec([&parser, chunk] {
+                    return parallel_detail::Tokenize(parser, chunk);
+                }));
+            for (auto& f : parsed) {
+                for (const auto& token : f.get())
+                    std::visit([&parser](auto value) { parallel_detail::Replay(parser, value); },
+                               token);
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+        parallel_detail::WaitAll(parsed);
+        if (error)
+            std::rethrow_exception(error);
+    }
+    parser.end();
+}
+
+#endif  // TOKEN_PARALLEL_TCC
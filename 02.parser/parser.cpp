@@ -1,5 +1,3 @@
-#include <charconv>
-#include <cctype>
 #include "parser.h"
 
 void TokenParser::set_start_callback(DefaultCallBack startCB) {
@@ -9,46 +7,89 @@ void TokenParser::set_number_callback(NumberCallBack numberCB) {
     if (numberCB != nullptr) _numCB = numberCB;
 }
 void TokenParser::set_string_callback(StringCallBack stringCB) {
+    if (stringCB != nullptr)
+        _strCB = [stringCB](std::string_view token) { stringCB(std::string(token)); };
+}
+void TokenParser::set_string_view_callback(StringViewCallBack stringCB) {
     if (stringCB != nullptr) _strCB = stringCB;
 }
 void TokenParser::set_end_callback(DefaultCallBack endCB) {
     if (endCB != nullptr) _endCB = endCB;
 }
 
-namespace {
-
-void LeftStrip(std::string_view& sv) {
-    while (!sv.empty() && std::isspace(sv[0]))
-        sv.remove_prefix(1);
+void TokenParser::set_signed_callback(SignedCallBack signedCB) {
+    if (signedCB == nullptr) return;
+    _signedCB = signedCB;
+    _classes |= token_class::SIGNED;
 }
-
-std::string_view ReadToken(std::string_view& sv) {
-    LeftStrip(sv);
-
-    auto pos = sv.find_first_of(" \t\n");
-    auto result = sv.substr(0, pos);
-    sv.remove_prefix(pos != sv.npos ? pos : sv.size());
-    return result;
+void TokenParser::set_double_callback(DoubleCallBack doubleCB) {
+    if (doubleCB == nullptr) return;
+    _doubleCB = doubleCB;
+    _classes |= token_class::FLOAT;
 }
-
-bool IsEndOfToken(char ch) {
-    return (ch == '\0' || std::isspace(ch));
+void TokenParser::set_hex_numbers(bool enable) {
+    _classes = enable ? _classes | token_class::HEX : _classes & ~token_class::HEX;
 }
 
-}  // namespace
-
 void TokenParser::run(std::string_view sv) const {
+    start();
+    run_tokens(sv);
+    end();
+}
+void TokenParser::run_tokens(std::string_view sv) const {
+    // the typed callbacks are only called for the classes they enable
+    tokenize(sv, Overloaded{[this](uint64_t num) { _numCB(num); },
+                            [this](int64_t num) { _signedCB(num); },
+                            [this](double num) { _doubleCB(num); }},
+             std::cref(_strCB));
+}
+void TokenParser::start() const {
     _startCB();
-    uint64_t number;
+}
+void TokenParser::end() const {
+    _endCB();
+}
+void TokenParser::number(uint64_t num) const {
+    _numCB(num);
+}
+void TokenParser::number(int64_t num) const {
+    _signedCB(num);
+}
+void TokenParser::number(double num) const {
+    _doubleCB(num);
+}
+void TokenParser::string(std::string_view token) const {
+    _strCB(token);
+}
 
-    while (!sv.empty()) {
-        if (auto token = ReadToken(sv);
-            !token.empty()) {
-            auto [ptr, errc] = std::from_chars(token.begin(), token.end(), number);
-            (errc == std::errc() && IsEndOfToken(*ptr))
-                ? _numCB(number)
-                : _strCB(std::string(token));
+TokenBatcher::TokenBatcher(std::string_view sv)
+    : _begin(sv.data()), _end(sv.data() + sv.size()), _pos(_begin),
+      _scan(_begin, _end) {}
+
+size_t TokenBatcher::next(const TokenBatch& batch) {
+    // locals, so that stores to the batch arrays cannot alias the state
+    scanner::Scanner scan = _scan;
+    const char* pos = _pos;
+    size_t count = 0u;
+    auto onNumber = [&](uint64_t num) {
+        batch.kinds[count] = TokenKind::NUMBER;
+        batch.values[count] = num;
+    };
+    auto onString = [&](std::string_view) {
+        batch.kinds[count] = TokenKind::STRING;
+        batch.values[count] = 0u;
+    };
+    for (; count != batch.capacity; count++) {
+        const char* start = scan.skip_spaces(pos);
+        if (start == _end) {
+            pos = _end;
+            break;
         }
+        pos = parser_detail::ParseToken<TokenSyntax<>>(scan, start, _end, onNumber, onString);
+        batch.offsets[count] = start - _begin;
+        batch.lengths[count] = pos - start;
     }
-    _endCB();
+    _scan = scan;
+    _pos = pos;
+    return count;
 }
@@ -5,11 +5,95 @@
 #include <string_view>
 #include <functional>
 
+#include "scanner.h"
+
+// Callback that ignores its arguments, for unused slots of BasicTokenParser.
+struct NoCallback {
+    template<class... Args>
+    void operator()(const Args&...) const {}
+};
+
+// Several lambdas as one callback, for number callbacks taking typed numbers.
+template<class... Funcs>
+struct Overloaded : Funcs... {
+    using Funcs::operator()...;
+};
+template<class... Funcs>
+Overloaded(Funcs...) -> Overloaded<Funcs...>;
+
+// Token classes besides unsigned numbers and strings, off by default.
+namespace token_class {
+
+// -12, +7: int64_t
+constexpr unsigned SIGNED = 1u << 0;
+// 0x1f, 0X1F: uint64_t
+constexpr unsigned HEX    = 1u << 1;
+// 1.5, -2e10, .5: double
+constexpr unsigned FLOAT  = 1u << 2;
+
+}  // namespace token_class
+
+// What the parser treats as tokens. With delimiters other than the default
+// ones spaces around a token are dropped and a number has to fill the rest;
+// the default ones keep spaces that are not delimiters ("abc\r\n" is "abc\r").
+// Each delimiter that is not a space closes a field: "a,,b" is "a", "", "b".
+// A field closed by a space delimiter or the end of the input is only
+// passed on when it is not empty, so "1,\n2," is "1", "2".
+template<class Delims = scanner::DefaultDelimiters, unsigned Classes = 0u>
+struct TokenSyntax {
+    using Delimiters = Delims;
+    static constexpr unsigned CLASSES = Classes;
+};
+
+// TokenParser with callables fixed at compile time: the dispatch loop is
+// instantiated for the given lambdas or functors, so calls to them inline.
+// OnString is called with std::string_view into the parsed string.
+// OnNumber is called with uint64_t, and with int64_t or double for the
+// classes enabled in Syntax.
+template<class OnStart, class OnNumber, class OnString, class OnEnd,
+         class Syntax = TokenSyntax<>>
+class BasicTokenParser {
+ public:
+    using Delimiters = typename Syntax::Delimiters;
+
+ public:
+    BasicTokenParser(OnStart startCB, OnNumber numberCB, OnString stringCB, OnEnd endCB,
+                     Syntax syntax = {});
+
+    // start(), run_tokens(), end()
+    void run(std::string_view strv_to_parse);
+
+    // number and string callbacks only, for input split into several pieces
+    // right after delimiters
+    void run_tokens(std::string_view strv_to_parse);
+    void start();
+    void end();
+
+    // single callbacks, for tokens parsed elsewhere
+    template<class Number>
+    void number(Number num);
+    void string(std::string_view token);
+
+    // run_tokens() with the parser's syntax and other callbacks
+    template<class OnNum, class OnStr>
+    void tokenize(std::string_view strv_to_parse, OnNum numberCB, OnStr stringCB) const;
+
+ private:
+    OnStart  _startCB;
+    OnNumber _numCB;
+    OnString _strCB;
+    OnEnd    _endCB;
+};
+
 class TokenParser {
  public:
     using DefaultCallBack = std::function<void(void)>;
     using StringCallBack  = std::function<void(const std::string&)>;
+    using StringViewCallBack = std::function<void(std::string_view)>;
     using NumberCallBack  = std::function<void(uint64_t)>;
+    using SignedCallBack  = std::function<void(int64_t)>;
+    using DoubleCallBack  = std::function<void(double)>;
+    using Delimiters = scanner::DefaultDelimiters;
 
  public:
     TokenParser() = default;
@@ -17,15 +101,72 @@ class TokenParser {
     void set_start_callback(DefaultCallBack startCB);
     void set_number_callback(NumberCallBack numberCB);
     void set_string_callback(StringCallBack stringCB);
+    // token is a view into the string passed to run(), no copy is made
+    void set_string_view_callback(StringViewCallBack stringCB);
     void set_end_callback(DefaultCallBack endCB);
+    // Signed, hex and floating point tokens go to the string callback
+    // until they are enabled with one of these.
+    void set_signed_callback(SignedCallBack signedCB);
+    void set_double_callback(DoubleCallBack doubleCB);
+    // hex tokens go to the number callback
+    void set_hex_numbers(bool enable);
 
     void run(std::string_view strv_to_parse) const;
 
+    // pieces of run() for TokenStream and ParseParallel
+    void run_tokens(std::string_view strv_to_parse) const;
+    void start() const;
+    void end() const;
+    void number(uint64_t num) const;
+    void number(int64_t num) const;
+    void number(double num) const;
+    void string(std::string_view token) const;
+
+    template<class OnNum, class OnStr>
+    void tokenize(std::string_view strv_to_parse, OnNum numberCB, OnStr stringCB) const;
+
  private:
     DefaultCallBack _startCB = []{};
     NumberCallBack  _numCB   = [](uint64_t){};
-    StringCallBack  _strCB   = [](const std::string&){};
+    StringViewCallBack _strCB = [](std::string_view){};
     DefaultCallBack _endCB   = []{};
+    SignedCallBack  _signedCB = nullptr;
+    DoubleCallBack  _doubleCB = nullptr;
+    unsigned _classes = 0u;
+};
+
+enum class TokenKind : uint8_t {
+    NUMBER,
+    STRING
 };
 
+// Caller-owned arrays of `capacity` entries, one record per token spread over
+// them (structure of arrays). Offsets are from the start of the parsed string.
+// value is 0 for strings, so numbers can be summed without looking at kinds.
+struct TokenBatch {
+    TokenKind* kinds;
+    size_t*    offsets;
+    size_t*    lengths;
+    uint64_t*  values;
+    size_t     capacity;
+};
+
+// Pull-style alternative to the callbacks: next() fills a batch with the
+// following tokens of the string, the same ones run() would report.
+class TokenBatcher {
+ public:
+    explicit TokenBatcher(std::string_view strv_to_parse);
+
+    // returns the number of records written, 0 once the string is over
+    size_t next(const TokenBatch& batch);
+
+ private:
+    const char* _begin;
+    const char* _end;
+    const char* _pos;
+    scanner::Scanner _scan;
+};
+
+#include "parser.tcc"
+
 #endif  // TOKEN_PARSER_H
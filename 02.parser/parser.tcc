@@ -0,0 +1,186 @@
+#ifndef TOKEN_PARSER_TCC
+#define TOKEN_PARSER_TCC
+
+#include <charconv>
+#include <cctype>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "parser.h"
+#include "scanner.h"
+
+namespace parser_detail {
+
+inline bool IsEndOfToken(char ch) {
+    return (ch == '\0' || std::isspace(ch));
+}
+
+inline bool IsDigit(char ch) {
+    return static_cast<unsigned char>(ch - '0') <= 9u;
+}
+
+// Passes [pos, end) to numCB if it is a number of one of the classes,
+// returns false otherwise.
+template<unsigned Classes, class OnNumber>
+bool ParseTyped(const char* pos, const char* end, OnNumber& numCB) {
+    if constexpr ((Classes & token_class::SIGNED) != 0u) {
+        if (*pos == '-' || *pos == '+') {
+            auto [digits_end, magnitude, overflow] = scanner::ParseNumber(pos + 1, end);
+            constexpr uint64_t MAX = std::numeric_limits<int64_t>::max();
+            if (digits_end == end && digits_end != pos + 1 && !overflow
+                && magnitude <= MAX + (*pos == '-')) {
+                numCB(static_cast<int64_t>(*pos == '-' ? 0u - magnitude : magnitude));
+                return true;
+            }
+        }
+    }
+    if constexpr ((Classes & token_class::HEX) != 0u) {
+        if (end - pos > 2 && pos[0] == '0' && (pos[1] == 'x' || pos[1] == 'X')) {
+            uint64_t number;
+            auto [ptr, errc] = std::from_chars(pos + 2, end, number, 16);
+            if (errc == std::errc() && ptr == end) {
+                numCB(number);
+                return true;
+            }
+        }
+    }
+    if constexpr ((Classes & token_class::FLOAT) != 0u) {
+        // decimal notation only, "inf" and "nan" stay strings
+        const char* first = pos + (*pos == '-' || *pos == '+');
+        if (first != end && (IsDigit(*first) || *first == '.')) {
+            double number;
+            auto [ptr, errc] = std::from_chars(pos + (*pos == '+'), end, number);
+            if (errc == std::errc() && ptr == end) {
+                numCB(number);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Passes the token starting at pos to one of the callbacks, returns its end.
+template<class Syntax, class OnNumber, class OnString>
+const char* ParseToken(scanner::BasicScanner<typename Syntax::Delimiters>& scan,
+                       const char* pos, const char* end,
+                       OnNumber& numCB, OnString& strCB) {
+    using Delimiters = typename Syntax::Delimiters;
+    // digits are converted while the token end is searched for
+    auto [digits_end, number, overflow] = scanner::ParseNumber(pos, end);
+    bool is_number = digits_end != pos && !overflow;
+    const char* token_end = digits_end;
+    const char* value_end = digits_end;
+    if (digits_end != end && !Delimiters::contains(*digits_end)) {
+        token_end = scan.find_delimiter(digits_end);
+        value_end = token_end;
+        if constexpr (std::is_same_v<Delimiters, scanner::DefaultDelimiters>) {
+            // any space after the digits ends a number, strings keep them ("abc\r")
+            is_number = is_number && IsEndOfToken(*digits_end);
+        } else {
+            // spaces before the delimiter ("42\r\n") are not part of the token,
+            // the loop stops at pos, which is not a space
+            while (scanner::IsSpace(value_end[-1]))
+                --value_end;
+            is_number = is_number && value_end == digits_end;
+        }
+    }
+    if (is_number)
+        numCB(number);
+    else if (!ParseTyped<Syntax::CLASSES>(pos, value_end, numCB))
+        strCB(std::string_view(pos, value_end - pos));
+    return token_end;
+}
+
+template<class Syntax, class OnNumber, class OnString>
+void RunTokens(std::string_view sv, OnNumber& numCB, OnString& strCB) {
+    using Delimiters = typename Syntax::Delimiters;
+    const char* end = sv.data() + sv.size();
+    scanner::BasicScanner<Delimiters> scan(sv.data(), end);
+    // whether a token was passed since the last delimiter; input split
+    // right after a delimiter starts in the same state as a new one
+    bool in_field = false;
+    for (const char* pos = scan.skip_spaces(sv.data());
+         pos != end;
+         pos = scan.skip_spaces(pos)) {
+        if constexpr (!Delimiters::ONLY_SPACES) {
+            if (Delimiters::contains(*pos)) {
+                // "a,,b": a delimiter other than a space closes a field, maybe empty
+                if (!in_field && !scanner::IsSpace(*pos))
+                    strCB(std::string_view(pos, 0u));
+                in_field = false;
+                ++pos;
+                continue;
+            }
+        }
+        pos = ParseToken<Syntax>(scan, pos, end, numCB, strCB);
+        in_field = true;
+    }
+}
+
+// RunTokens for the classes known at run time only
+template<class Delims, class OnNumber, class OnString, unsigned... Classes>
+void RunTokens(unsigned classes, std::string_view sv, OnNumber& numCB, OnString& strCB,
+               std::integer_sequence<unsigned, Classes...>) {
+    ((classes == Classes ? RunTokens<TokenSyntax<Delims, Classes>>(sv, numCB, strCB)
+                         : void()), ...);
+}
+
+}  // namespace parser_detail
+
+template<class OnStart, class OnNumber, class OnString, class OnEnd, class Syntax>
+BasicTokenParser<OnStart, OnNumber, OnString, OnEnd, Syntax>::BasicTokenParser(
+    OnStart startCB, OnNumber numberCB, OnString stringCB, OnEnd endCB, Syntax)
+    : _startCB(std::move(startCB)), _numCB(std::move(numberCB)),
+      _strCB(std::move(stringCB)), _endCB(std::move(endCB)) {}
+
+template<class OnStart, class OnNumber, class OnString, class OnEnd, class Syntax>
+void BasicTokenParser<OnStart, OnNumber, OnString, OnEnd, Syntax>::run(std::string_view sv) {
+    start();
+    run_tokens(sv);
+    end();
+}
+
+template<class OnStart, class OnNumber, class OnString, class OnEnd, class Syntax>
+void BasicTokenParser<OnStart, OnNumber, OnString, OnEnd, Syntax>::run_tokens(
+    std::string_view sv) {
+    parser_detail::RunTokens<Syntax>(sv, _numCB, _strCB);
+}
+
+template<class OnStart, class OnNumber, class OnString, class OnEnd, class Syntax>
+void BasicTokenParser<OnStart, OnNumber, OnString, OnEnd, Syntax>::start() {
+    _startCB();
+}
+
+template<class OnStart, class OnNumber, class OnString, class OnEnd, class Syntax>
+void BasicTokenParser<OnStart, OnNumber, OnString, OnEnd, Syntax>::end() {
+    _endCB();
+}
+
+template<class OnStart, class OnNumber, class OnString, class OnEnd, class Syntax>
+template<class Number>
+void BasicTokenParser<OnStart, OnNumber, OnString, OnEnd, Syntax>::number(Number num) {
+    _numCB(num);
+}
+
+template<class OnStart, class OnNumber, class OnString, class OnEnd, class Syntax>
+void BasicTokenParser<OnStart, OnNumber, OnString, OnEnd, Syntax>::string(
+    std::string_view token) {
+    _strCB(token);
+}
+
+template<class OnStart, class OnNumber, class OnString, class OnEnd, class Syntax>
+template<class OnNum, class OnStr>
+void BasicTokenParser<OnStart, OnNumber, OnString, OnEnd, Syntax>::tokenize(
+    std::string_view sv, OnNum numberCB, OnStr stringCB) const {
+    parser_detail::RunTokens<Syntax>(sv, numberCB, stringCB);
+}
+
+template<class OnNum, class OnStr>
+void TokenParser::tokenize(std::string_view sv, OnNum numberCB, OnStr stringCB) const {
+    constexpr unsigned ALL = token_class::SIGNED | token_class::HEX | token_class::FLOAT;
+    parser_detail::RunTokens<Delimiters>(_classes, sv, numberCB, stringCB,
+                                         std::make_integer_sequence<unsigned, ALL + 1u>());
+}
+
+#endif  // TOKEN_PARSER_TCC
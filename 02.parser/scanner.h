@@ -0,0 +1,305 @@
+#ifndef TOKEN_SCANNER_H
+#define TOKEN_SCANNER_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Token boundary search for TokenParser.
+// Spaces (std::isspace in the "C" locale) are skipped before a token, a token
+// ends at the first delimiter. The delimiter set is a template parameter,
+// ' ', '\t' and '\n' by default. Delimiters of a set with other characters
+// than spaces are not skipped, the parser counts the fields they close.
+// Blocks of 16 (SSE2) or 32 (AVX2) bytes are classified at once,
+// the tail and targets without SSE2 fall back to the scalar loops.
+// Scanner below is the fast path for walking a whole buffer.
+// ParseNumber reads a run of digits 8 bytes at a time (SWAR).
+namespace scanner {
+
+// end of the digits at the start of a token and their value;
+// overflow is set when the value does not fit uint64_t
+struct NumberResult {
+    const char* ptr;
+    uint64_t value;
+    bool overflow;
+};
+
+constexpr bool IsSpace(char ch) {
+    return ch == ' ' || static_cast<unsigned char>(ch - '\t') <= '\r' - '\t';
+}
+
+// Delimiter characters fixed at compile time, looked up in a 256-entry table.
+template<char... Chars>
+struct DelimiterSet {
+    static constexpr std::array<bool, 256> TABLE = [] {
+        std::array<bool, 256> table{};
+        ((table[static_cast<unsigned char>(Chars)] = true), ...);
+        return table;
+    }();
+
+    // delimiters are skipped with the spaces anyway, no extra check needed
+    static constexpr bool ONLY_SPACES = (IsSpace(Chars) && ...);
+
+    static constexpr bool contains(char ch) {
+        // a few compares beat the table load in the scalar loops
+        if constexpr (sizeof...(Chars) <= 4u)
+            return ((ch == Chars) || ...);
+        else
+            return TABLE[static_cast<unsigned char>(ch)];
+    }
+};
+
+using DefaultDelimiters = DelimiterSet<' ', '\t', '\n'>;
+
+inline bool IsDelimiter(char ch) {
+    return DefaultDelimiters::contains(ch);
+}
+
+// characters skipped before a token
+template<class Delims = DefaultDelimiters>
+bool IsSeparator(char ch) {
+    return IsSpace(ch) && (Delims::ONLY_SPACES || !Delims::contains(ch));
+}
+
+namespace scalar {
+
+template<class Delims = DefaultDelimiters>
+const char* SkipSpaces(const char* p, const char* end) {
+    while (p != end && IsSeparator<Delims>(*p))
+        ++p;
+    return p;
+}
+
+template<class Delims = DefaultDelimiters>
+const char* FindDelimiter(const char* p, const char* end) {
+    while (p != end && !Delims::contains(*p))
+        ++p;
+    return p;
+}
+
+inline NumberResult ParseNumber(const char* p, const char* end) {
+    NumberResult res{p, 0u, false};
+    for (; res.ptr != end && static_cast<unsigned char>(*res.ptr - '0') <= 9u; ++res.ptr) {
+        res.overflow |= __builtin_mul_overflow(res.value, 10u, &res.value);
+        res.overflow |= __builtin_add_overflow(res.value, *res.ptr - '0', &res.value);
+    }
+    return res;
+}
+
+}  // namespace scalar
+
+#if defined(__AVX2__)
+
+constexpr size_t BLOCK_SIZE = 32u;
+
+inline uint32_t SpaceMask(const char* p) {
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    // '\t'..'\r' are the only bytes for which (ch - '\t') as unsigned is <= 4
+    __m256i ctrl = _mm256_sub_epi8(block, _mm256_set1_epi8('\t'));
+    ctrl = _mm256_cmpeq_epi8(_mm256_max_epu8(ctrl, _mm256_set1_epi8(4)), _mm256_set1_epi8(4));
+    __m256i space = _mm256_cmpeq_epi8(block, _mm256_set1_epi8(' '));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(ctrl, space)));
+}
+
+template<char... Chars>
+uint32_t DelimiterMask(const char* p, DelimiterSet<Chars...>) {
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i mask = _mm256_setzero_si256();
+    ((mask = _mm256_or_si256(mask, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(Chars)))), ...);
+    return static_cast<uint32_t>(_mm256_movemask_epi8(mask));
+}
+
+#elif defined(__SSE2__)
+
+constexpr size_t BLOCK_SIZE = 16u;
+
+inline uint32_t SpaceMask(const char* p) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    // '\t'..'\r' are the only bytes for which (ch - '\t') as unsigned is <= 4
+    __m128i ctrl = _mm_sub_epi8(block, _mm_set1_epi8('\t'));
+    ctrl = _mm_cmpeq_epi8(_mm_max_epu8(ctrl, _mm_set1_epi8(4)), _mm_set1_epi8(4));
+    __m128i space = _mm_cmpeq_epi8(block, _mm_set1_epi8(' '));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(ctrl, space)));
+}
+
+template<char... Chars>
+uint32_t DelimiterMask(const char* p, DelimiterSet<Chars...>) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i mask = _mm_setzero_si128();
+    ((mask = _mm_or_si128(mask, _mm_cmpeq_epi8(block, _mm_set1_epi8(Chars)))), ...);
+    return static_cast<uint32_t>(_mm_movemask_epi8(mask));
+}
+
+#endif
+
+#if defined(__SSE2__)
+
+template<class Delims>
+uint32_t SeparatorMask(const char* p) {
+    if constexpr (Delims::ONLY_SPACES)
+        return SpaceMask(p);
+    else
+        return SpaceMask(p) & ~DelimiterMask(p, Delims{});
+}
+
+#endif
+
+template<class Delims = DefaultDelimiters>
+const char* SkipSpaces(const char* p, const char* end) {
+#if defined(__SSE2__)
+    // tokens are usually separated by a single space
+    if (p != end && !IsSeparator<Delims>(*p))
+        return p;
+    constexpr uint32_t FULL = static_cast<uint32_t>((uint64_t{1} << BLOCK_SIZE) - 1u);
+    for (; static_cast<size_t>(end - p) >= BLOCK_SIZE; p += BLOCK_SIZE) {
+        if (uint32_t mask = ~SeparatorMask<Delims>(p) & FULL; mask != 0u)
+            return p + __builtin_ctz(mask);
+    }
+#endif
+    return scalar::SkipSpaces<Delims>(p, end);
+}
+
+template<class Delims = DefaultDelimiters>
+const char* FindDelimiter(const char* p, const char* end) {
+#if defined(__SSE2__)
+    for (; static_cast<size_t>(end - p) >= BLOCK_SIZE; p += BLOCK_SIZE) {
+        if (uint32_t mask = DelimiterMask(p, Delims{}); mask != 0u)
+            return p + __builtin_ctz(mask);
+    }
+#endif
+    return scalar::FindDelimiter<Delims>(p, end);
+}
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+
+namespace swar {
+
+constexpr uint64_t ONES = 0x0101010101010101u;
+
+// number of leading digit characters in the 8 bytes, the first byte is lowest
+inline unsigned CountDigits(uint64_t bytes) {
+    // high bit of a byte is set for bytes outside '0'..'9'
+    uint64_t low = bytes - ONES * '0';
+    uint64_t high = bytes + ONES * (0x7fu - '9');
+    uint64_t non_digit = (low | high | bytes) & ONES * 0x80u;
+    return non_digit == 0u ? 8u : __builtin_ctzll(non_digit) / 8u;
+}
+
+// value of n (1 to 8) leading digits
+inline uint64_t DigitsValue(uint64_t bytes, unsigned n) {
+    // drop the bytes after the digits, the zero bytes shifted in act as leading zeros
+    uint64_t val = (bytes - ONES * '0') << (8u * (8u - n));
+    val = (val * 10u + (val >> 8)) & 0x00ff00ff00ff00ffu;
+    val = (val * 100u + (val >> 16)) & 0x0000ffff0000ffffu;
+    return (val * 10000u + (val >> 32)) & 0xffffffffu;
+}
+
+}  // namespace swar
+
+#endif
+
+// Same as scalar::ParseNumber, 8 digits per step.
+inline NumberResult ParseNumber(const char* p, const char* end) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    constexpr uint64_t POW10[] = {1u, 10u, 100u, 1000u, 10000u, 100000u,
+                                  1000000u, 10000000u, 100000000u};
+    NumberResult res{p, 0u, false};
+    while (end - res.ptr >= 8) {
+        uint64_t bytes;
+        std::memcpy(&bytes, res.ptr, sizeof(bytes));
+        unsigned n = swar::CountDigits(bytes);
+        if (n == 0u)
+            return res;
+        res.overflow |= __builtin_mul_overflow(res.value, POW10[n], &res.value);
+        res.overflow |= __builtin_add_overflow(res.value, swar::DigitsValue(bytes, n), &res.value);
+        res.ptr += n;
+        if (n != 8u)
+            return res;
+    }
+    NumberResult tail = scalar::ParseNumber(res.ptr, end);
+    res.overflow |= __builtin_mul_overflow(res.value, POW10[tail.ptr - res.ptr], &res.value);
+    res.overflow |= __builtin_add_overflow(res.value, tail.value, &res.value);
+    res.overflow |= tail.overflow;
+    res.ptr = tail.ptr;
+    return res;
+#else
+    return scalar::ParseNumber(p, end);
+#endif
+}
+
+// Forward-only scanner over [begin, end): classifies 64 bytes at a time into
+// space and delimiter bitmasks and walks the token boundaries inside the block
+// with shifts and bit scans. Positions passed in must never decrease.
+template<class Delims>
+class BasicScanner {
+ public:
+    BasicScanner(const char* begin, const char* end)
+        : _end(end), _block(begin) {
+        if (static_cast<size_t>(end - begin) >= WINDOW)
+            load(begin);
+    }
+
+    const char* skip_spaces(const char* p) {
+#if defined(__SSE2__)
+        while (static_cast<size_t>(_end - p) >= WINDOW) {
+            size_t offset = shift(p);
+            if (uint64_t mask = ~_spaces >> offset; mask != 0u)
+                return p + __builtin_ctzll(mask);
+            p = _block + WINDOW;
+        }
+#endif
+        return scalar::SkipSpaces<Delims>(p, _end);
+    }
+
+    const char* find_delimiter(const char* p) {
+#if defined(__SSE2__)
+        while (static_cast<size_t>(_end - p) >= WINDOW) {
+            size_t offset = shift(p);
+            if (uint64_t mask = _delims >> offset; mask != 0u)
+                return p + __builtin_ctzll(mask);
+            p = _block + WINDOW;
+        }
+#endif
+        return scalar::FindDelimiter<Delims>(p, _end);
+    }
+
+ private:
+    static constexpr size_t WINDOW = 64u;
+
+    // offset of p in the current window, reloading it at p when p is past it
+    size_t shift(const char* p) {
+        size_t offset = p - _block;
+        if (offset < WINDOW)
+            return offset;
+        load(p);
+        return 0u;
+    }
+
+    void load(const char* p) {
+        _block = p;
+        _spaces = _delims = 0u;
+#if defined(__SSE2__)
+        for (size_t i = 0; i < WINDOW; i += BLOCK_SIZE) {
+            _spaces |= uint64_t{SeparatorMask<Delims>(p + i)} << i;
+            _delims |= uint64_t{DelimiterMask(p + i, Delims{})} << i;
+        }
+#endif
+    }
+
+ private:
+    const char* _end;
+    const char* _block;
+    uint64_t _spaces = 0u;
+    uint64_t _delims = 0u;
+};
+
+using Scanner = BasicScanner<DefaultDelimiters>;
+
+}  // namespace scanner
+
+#endif  // TOKEN_SCANNER_H
@@ -0,0 +1,45 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+#include <string>
+#include <string_view>
+#include <istream>
+
+inline constexpr size_t STREAM_CHUNK_SIZE = 1u << 20;
+
+// Push-style front end for TokenParser or BasicTokenParser: input is fed in
+// chunks of any size, a token cut by a chunk border is kept until its end
+// arrives. Callbacks are invoked as if the concatenated input went to run().
+// Memory used is bounded by the longest token, not by the input size.
+template<class Parser>
+class TokenStream {
+ public:
+    explicit TokenStream(Parser& parser);
+
+    // calls the start callback on the first chunk
+    void feed(std::string_view chunk);
+    // parses the rest of the input and calls the end callback
+    void finish();
+
+ private:
+    Parser& _parser;
+    std::string _pending;
+    bool _started = false;
+};
+
+// Drivers parse the whole input through TokenStream. The next chunk is read
+// by another thread while the current one is parsed.
+// I/O errors are reported with std::system_error (std::ios_base::failure).
+template<class Parser>
+void ParseStream(Parser& parser, std::istream& input, size_t chunk_size = STREAM_CHUNK_SIZE);
+
+template<class Parser>
+void ParseFd(Parser& parser, int fd, size_t chunk_size = STREAM_CHUNK_SIZE);
+
+// maps the file and drops the pages behind the parsed window
+template<class Parser>
+void ParseFile(Parser& parser, const std::string& filename, size_t chunk_size = STREAM_CHUNK_SIZE);
+
+#include "stream.tcc"
+
+#endif  // TOKEN_STREAM_H
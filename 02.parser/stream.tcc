@@ -0,0 +1,151 @@
+#ifndef TOKEN_STREAM_TCC
+#define TOKEN_STREAM_TCC
+
+#include <algorithm>
+#include <cerrno>
+#include <future>
+#include <memory>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "stream.h"
+#include "scanner.h"
+
+template<class Parser>
+TokenStream<Parser>::TokenStream(Parser& parser)
+    : _parser(parser) {}
+
+template<class Parser>
+void TokenStream<Parser>::feed(std::string_view chunk) {
+    if (!_started) {
+        _parser.start();
+        _started = true;
+    }
+    const char* begin = chunk.data();
+    const char* end = begin + chunk.size();
+    if (!_pending.empty()) {
+        const char* delim = scanner::FindDelimiter<typename Parser::Delimiters>(begin, end);
+        if (delim == end) {
+            _pending.append(begin, end);
+            return;
+        }
+        // with its delimiter, the next piece starts after one as well
+        _pending.append(begin, delim + 1);
+        _parser.run_tokens(_pending);
+        _pending.clear();
+        begin = delim + 1;
+    }
+    const char* last = end;
+    while (last != begin && !Parser::Delimiters::contains(last[-1]))
+        --last;
+    _parser.run_tokens(std::string_view(begin, last - begin));
+    _pending.assign(last, end);
+}
+
+template<class Parser>
+void TokenStream<Parser>::finish() {
+    if (!_started)
+        _parser.start();
+    _parser.run_tokens(_pending);
+    _pending.clear();
+    _started = false;
+    _parser.end();
+}
+
+namespace stream_detail {
+
+// read(chunk) fills the buffer and returns the number of bytes, 0 at the end
+template<class Parser, class Read>
+void ParseDoubleBuffered(Parser& parser, size_t chunk_size, Read read) {
+    TokenStream stream(parser);
+    std::unique_ptr<char[]> buffers[2] = {
+        std::make_unique<char[]>(chunk_size), std::make_unique<char[]>(chunk_size)
+    };
+    std::future<size_t> next = std::async(std::launch::async, read, buffers[0].get());
+    for (size_t curr = 0u;; curr ^= 1u) {
+        size_t size = next.get();
+        if (size == 0u)
+            break;
+        next = std::async(std::launch::async, read, buffers[curr ^ 1u].get());
+        stream.feed(std::string_view(buffers[curr].get(), size));
+    }
+    stream.finish();
+}
+
+struct FdCloser {
+    void operator()(const int* fd) const { ::close(*fd); }
+};
+
+}  // namespace stream_detail
+
+template<class Parser>
+void ParseStream(Parser& parser, std::istream& input, size_t chunk_size) {
+    stream_detail::ParseDoubleBuffered(parser, chunk_size, [&input, chunk_size](char* buf) {
+        input.read(buf, chunk_size);
+        if (input.bad())
+            throw std::ios_base::failure("ParseStream: read error");
+        return static_cast<size_t>(input.gcount());
+    });
+}
+
+template<class Parser>
+void ParseFd(Parser& parser, int fd, size_t chunk_size) {
+    stream_detail::ParseDoubleBuffered(parser, chunk_size, [fd, chunk_size](char* buf) {
+        size_t size = 0u;
+        while (size != chunk_size) {
+            ssize_t n = ::read(fd, buf + size, chunk_size - size);
+            if (n == 0)
+                break;
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw std::system_error(errno, std::generic_category(), "ParseFd: read");
+            }
+            size += n;
+        }
+        return size;
+    });
+}
+
+template<class Parser>
+void ParseFile(Parser& parser, const std::string& filename, size_t chunk_size) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), "ParseFile: open " + filename);
+    std::unique_ptr<int, stream_detail::FdCloser> guard(&fd);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+        throw std::system_error(errno, std::generic_category(), "ParseFile: fstat " + filename);
+    const size_t size = st.st_size;
+
+    TokenStream stream(parser);
+    if (size != 0u) {
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+            throw std::system_error(errno, std::generic_category(), "ParseFile: mmap " + filename);
+        auto unmap = [size](char* p) { ::munmap(p, size); };
+        std::unique_ptr<char, decltype(unmap)> map(static_cast<char*>(addr), unmap);
+        ::madvise(addr, size, MADV_SEQUENTIAL);
+
+        const size_t page = ::sysconf(_SC_PAGESIZE);
+        size_t dropped = 0u;
+        for (size_t offset = 0u; offset < size; offset += chunk_size) {
+            const size_t len = std::min(chunk_size, size - offset);
+            stream.feed(std::string_view(map.get() + offset, len));
+            // everything before offset + len is parsed or copied by the stream
+            if (size_t done = (offset + len) / page * page; done > dropped) {
+                ::madvise(map.get() + dropped, done - dropped, MADV_DONTNEED);
+                dropped = done;
+            }
+        }
+    }
+    stream.finish();
+}
+
+#endif  // TOKEN_STREAM_TCC
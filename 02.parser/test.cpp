@@ -1,4 +1,23 @@
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <random>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <system_error>
+#include <filesystem>
+#include <thread>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "parallel.h"
 #include "parser.h"
+#include "scanner.h"
+#include "stream.h"
 #include "test_runner.h"
 
 void TestInteger();
@@ -6,6 +25,19 @@ void TestString();
 void TestStartAndEnd();
 void TestUsage();
 void TestNullptr();
+void TestStringView();
+void TestBasicTokenParser();
+void TestScanner();
+void TestParseNumber();
+void TestLongInput();
+void TestStream();
+void TestStreamDrivers();
+void TestSplitChunks();
+void TestParallel();
+void TestParallelExceptions();
+void TestBatch();
+void TestDelimiters();
+void TestTokenClasses();
 
 void TestInteger() {
     {
@@ -93,6 +125,61 @@ void TestString() {
     }
 }
 
+void TestStringView() {
+    TokenParser pr;
+    std::vector<std::string_view> res;
+    pr.set_string_view_callback([&](std::string_view s) {
+        res.push_back(s);
+    });
+
+    const std::string str = " ab 12\tc,d\n1a ";
+    pr.run(str);
+    ASSERT_EQUAL(res.size(), 3u);
+    ASSERT(res[0] == "ab" && res[0].data() == str.data() + 1);
+    ASSERT(res[1] == "c,d" && res[1].data() == str.data() + 7);
+    ASSERT(res[2] == "1a" && res[2].data() == str.data() + 11);
+
+    // nullptr keeps the callback set before, as for the other setters
+    pr.set_string_view_callback(nullptr);
+    pr.run("x");
+    ASSERT_EQUAL(res.size(), 4u);
+}
+
+struct NumberSum {
+    uint64_t& sum;
+    void operator()(uint64_t num) { sum += num; }
+};
+
+void TestBasicTokenParser() {
+    {
+        uint64_t sum = 0u;
+        std::vector<std::string_view> strs;
+        size_t starts = 0u, ends = 0u;
+        BasicTokenParser pr([&] { starts++; },
+                            NumberSum{sum},
+                            [&](std::string_view s) { strs.push_back(s); },
+                            [&] { ends++; });
+        pr.run("a 1 2\tb\n3 18446744073709551616");
+        ASSERT_EQUAL(sum, 6u);
+        ASSERT_EQUAL(strs, std::vector<std::string_view>({"a", "b", "18446744073709551616"}));
+        ASSERT_EQUAL(starts, 1u);
+        ASSERT_EQUAL(ends, 1u);
+
+        pr.run_tokens("10 c");
+        ASSERT_EQUAL(sum, 16u);
+        ASSERT_EQUAL(strs.size(), 4u);
+        ASSERT_EQUAL(starts, 1u);
+        ASSERT_EQUAL(ends, 1u);
+    }
+    {
+        std::vector<uint64_t> nums;
+        BasicTokenParser pr(NoCallback{}, [&](uint64_t num) { nums.push_back(num); },
+                            NoCallback{}, NoCallback{});
+        pr.run(" 1 a 0002\n");
+        ASSERT_EQUAL(nums, std::vector<uint64_t>({1, 2}));
+    }
+}
+
 void TestStartAndEnd() {
     auto run_parser_4_times = [&] (const TokenParser& p) {
         for (auto& str : {"1", "2", "3", "4"}) {
@@ -167,11 +254,528 @@ void TestNullptr() {
     }
 }
 
+void TestScanner() {
+    std::mt19937 gen(42);
+    const std::string alphabet = "ab1 \t\n\v\f\r";
+    std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+    for (size_t len = 0; len < 100; len++) {
+        std::string str(len, ' ');
+        for (char& ch : str)
+            ch = alphabet[pick(gen)];
+        const char* end = str.data() + str.size();
+        for (const char* pos = str.data(); pos != end; pos++) {
+            ASSERT(scanner::SkipSpaces(pos, end) == scanner::scalar::SkipSpaces(pos, end));
+            ASSERT(scanner::FindDelimiter(pos, end) == scanner::scalar::FindDelimiter(pos, end));
+        }
+    }
+    for (size_t len = 60; len < 300; len++) {
+        std::string str(len, ' ');
+        for (char& ch : str)
+            ch = alphabet[pick(gen)];
+        const char* end = str.data() + str.size();
+        scanner::Scanner scan(str.data(), end);
+        for (const char* pos = str.data(); pos != end; ) {
+            const char* start = scan.skip_spaces(pos);
+            ASSERT(start == scanner::scalar::SkipSpaces(pos, end));
+            pos = scan.find_delimiter(start);
+            ASSERT(pos == scanner::scalar::FindDelimiter(start, end));
+        }
+    }
+    {
+        std::string str(40, '\v');
+        ASSERT(scanner::SkipSpaces(str.data(), str.data() + str.size()) == str.data() + str.size());
+        str += "\xff";
+        ASSERT(scanner::SkipSpaces(str.data(), str.data() + str.size()) == str.data() + 40);
+    }
+}
+
+void TestParseNumber() {
+    std::mt19937 gen(42);
+    const std::string alphabet = "0123456789/:a \xff";
+    std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+    std::uniform_int_distribution<int> digit('0', '9');
+    for (size_t len = 0; len < 40; len++) {
+        for (int iter = 0; iter < 50; iter++) {
+            std::string str(len, '0');
+            for (char& ch : str)
+                ch = static_cast<char>(iter % 2 == 0 ? digit(gen) : alphabet[pick(gen)]);
+            const char* end = str.data() + str.size();
+            for (const char* pos = str.data(); pos != end; pos++) {
+                uint64_t expected = 0u;
+                auto [ptr, errc] = std::from_chars(pos, end, expected);
+                auto res = scanner::ParseNumber(pos, end);
+                ASSERT(res.ptr == scanner::scalar::ParseNumber(pos, end).ptr);
+                if (ptr == pos) {
+                    ASSERT(res.ptr == pos);
+                    continue;
+                }
+                ASSERT(res.ptr == ptr);
+                ASSERT_EQUAL(res.overflow, errc == std::errc::result_out_of_range);
+                if (!res.overflow)
+                    ASSERT_EQUAL(res.value, expected);
+            }
+        }
+    }
+    for (const std::string str : {"18446744073709551615", "18446744073709551616",
+                                  "000000000000000000000000018446744073709551615",
+                                  "99999999999999999999", "1844674407370955161x"}) {
+        uint64_t expected = 0u;
+        auto [ptr, errc] = std::from_chars(str.data(), str.data() + str.size(), expected);
+        auto res = scanner::ParseNumber(str.data(), str.data() + str.size());
+        ASSERT(res.ptr == ptr);
+        ASSERT_EQUAL(res.overflow, errc == std::errc::result_out_of_range);
+        if (!res.overflow)
+            ASSERT_EQUAL(res.value, expected);
+    }
+}
+
+void TestLongInput() {
+    TokenParser tp;
+    std::vector<std::string> strs;
+    std::vector<uint64_t> nums;
+    tp.set_string_callback([&](const std::string& s) { strs.push_back(s); });
+    tp.set_number_callback([&](uint64_t num) { nums.push_back(num); });
+
+    std::string long_token(100, 'x');
+    std::string spaces = " \t\n\v\f\r                                  ";
+    tp.run(spaces + long_token + spaces + "12345678901234567890" + spaces +
+           "\r\v42" + '\n' + long_token + "\r" + spaces);
+    ASSERT_EQUAL(strs, std::vector<std::string>({long_token, long_token + "\r"}));
+    ASSERT_EQUAL(nums, std::vector<uint64_t>({12345678901234567890ul, 42}));
+}
+
+namespace {
+
+struct Recorder {
+    std::string log;
+    TokenParser parser;
+
+    Recorder() {
+        parser.set_start_callback([this] { log += "<"; });
+        parser.set_number_callback([this](uint64_t num) { log += "n" + std::to_string(num) + ","; });
+        parser.set_string_view_callback([this](std::string_view s) {
+            log += "s";
+            log += s;
+            log += ",";
+        });
+        parser.set_end_callback([this] { log += ">"; });
+    }
+};
+
+const std::string STREAM_INPUT =
+    " \v12 ab\t\t345\n c\vd 18446744073709551616\r\n 7x  0001 \f";
+
+// File with a unique name in the temporary directory, removed on destruction
+class TempFile {
+ public:
+    explicit TempFile(std::string_view content) {
+        std::string name =
+            (std::filesystem::temp_directory_path() / "parser_test.XXXXXX").string();
+        int fd = ::mkstemp(name.data());
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "mkstemp");
+        _name = name;
+        ssize_t written = ::write(fd, content.data(), content.size());
+        ::close(fd);
+        if (written != static_cast<ssize_t>(content.size())) {
+            std::filesystem::remove(_name);
+            throw std::runtime_error("cannot write " + _name);
+        }
+    }
+
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    ~TempFile() {
+        std::error_code ec;
+        std::filesystem::remove(_name, ec);
+    }
+
+    const std::string& name() const { return _name; }
+
+ private:
+    std::string _name;
+};
+
+}  // namespace
+
+void TestStream() {
+    Recorder expected;
+    expected.parser.run(STREAM_INPUT);
+
+    for (size_t chunk = 1; chunk <= STREAM_INPUT.size(); chunk++) {
+        Recorder rec;
+        TokenStream stream(rec.parser);
+        for (size_t pos = 0; pos < STREAM_INPUT.size(); pos += chunk)
+            stream.feed(std::string_view(STREAM_INPUT).substr(pos, chunk));
+        stream.finish();
+        ASSERT_EQUAL(rec.log, expected.log);
+    }
+    {
+        Recorder rec;
+        TokenStream stream(rec.parser);
+        stream.finish();
+        stream.feed("1 2");
+        stream.feed("3");
+        stream.finish();
+        ASSERT_EQUAL(rec.log, "<><n1,n23,>");
+    }
+}
+
+void TestStreamDrivers() {
+    Recorder expected;
+    expected.parser.run(STREAM_INPUT);
+    {
+        Recorder rec;
+        std::istringstream input(STREAM_INPUT);
+        ParseStream(rec.parser, input, 5u);
+        ASSERT_EQUAL(rec.log, expected.log);
+    }
+    std::string filename;
+    {
+        TempFile file(STREAM_INPUT);
+        filename = file.name();
+        Recorder rec;
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        ASSERT(fd >= 0);
+        ParseFd(rec.parser, fd, 7u);
+        ::close(fd);
+        ASSERT_EQUAL(rec.log, expected.log);
+
+        rec.log.clear();
+        ParseFile(rec.parser, filename, 3u);
+        ASSERT_EQUAL(rec.log, expected.log);
+
+        uint64_t sum = 0u;
+        BasicTokenParser basic(NoCallback{}, [&](uint64_t num) { sum += num; },
+                               NoCallback{}, NoCallback{});
+        ParseFile(basic, filename);
+        ASSERT_EQUAL(sum, 12u + 345u + 1u);
+    }
+
+    // the TempFile removed the file
+    bool thrown = false;
+    try {
+        Recorder rec;
+        ParseFile(rec.parser, filename);
+    } catch (const std::system_error&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+}
+
+void TestSplitChunks() {
+    const std::string input = "aa bb\tcc\ndd  ee";
+    for (size_t n = 1; n <= input.size() + 1u; n++) {
+        auto chunks = SplitChunks(input, n);
+        ASSERT(chunks.size() <= n);
+        std::string joined;
+        for (size_t i = 0; i < chunks.size(); i++) {
+            ASSERT(!chunks[i].empty());
+            if (i != 0u)
+                ASSERT(scanner::IsDelimiter(chunks[i - 1].back()));
+            joined += chunks[i];
+        }
+        ASSERT_EQUAL(joined, input);
+    }
+    ASSERT_EQUAL(SplitChunks("abcdef", 4u).size(), 1u);
+    ASSERT(SplitChunks("", 4u).empty());
+    ASSERT_EQUAL(SplitChunks("a b", 0u).size(), 1u);
+}
+
+void TestParallel() {
+    std::string input;
+    for (int i = 0; i < 1000; i++)
+        input += std::to_string(i) + (i % 3 == 0 ? " w" + std::to_string(i) + "\n" : "\t");
+    input += STREAM_INPUT;
+
+    Recorder expected;
+    expected.parser.run(input);
+
+    ThreadPool pool(4u);
+    for (size_t n : {1u, 3u, 16u, 1000u}) {
+        Recorder rec;
+        ParseParallel(rec.parser, input, pool, n);
+        ASSERT_EQUAL(rec.log, expected.log);
+    }
+    {
+        std::mutex mutex;
+        std::vector<std::string> tokens;
+        std::atomic<int> starts = 0, ends = 0;
+        TokenParser parser;
+        parser.set_start_callback([&] { starts++; });
+        parser.set_number_callback([&](uint64_t num) {
+            std::lock_guard lk(mutex);
+            tokens.push_back(std::to_string(num));
+        });
+        parser.set_string_view_callback([&](std::string_view s) {
+            std::lock_guard lk(mutex);
+            tokens.emplace_back(s);
+        });
+        parser.set_end_callback([&] { ends++; });
+        ParseParallel(parser, input, pool, 16u, ParseOrder::UNORDERED);
+
+        std::vector<std::string> expected_tokens;
+        TokenParser single;
+        single.set_number_callback([&](uint64_t num) { expected_tokens.push_back(std::to_string(num)); });
+        single.set_string_view_callback([&](std::string_view s) { expected_tokens.emplace_back(s); });
+        single.run(input);
+        std::sort(tokens.begin(), tokens.end());
+        std::sort(expected_tokens.begin(), expected_tokens.end());
+        ASSERT_EQUAL(tokens, expected_tokens);
+        ASSERT_EQUAL(starts.load(), 1);
+        ASSERT_EQUAL(ends.load(), 1);
+    }
+
+    // nothing to exec() on: parsed on this thread in both modes
+    ThreadPool empty(0u);
+    ASSERT_EQUAL(empty.size(), 0u);
+    for (ParseOrder order : {ParseOrder::SEQUENTIAL, ParseOrder::UNORDERED}) {
+        Recorder rec;
+        ParseParallel(rec.parser, input, empty, 16u, order);
+        ASSERT_EQUAL(rec.log, expected.log);
+    }
+}
+
+void TestParallelExceptions() {
+    ThreadPool pool(4u);
+    for (ParseOrder order : {ParseOrder::SEQUENTIAL, ParseOrder::UNORDERED}) {
+        // the input and the parser are gone once the exception leaves
+        // this block, no task may still use them
+        try {
+            std::string input;
+            for (int i = 0; i < 20000; i++)
+                input += "w" + std::to_string(i) + " ";
+            TokenParser parser;
+            // later chunks are slow, so they are still parsed when w0 throws
+            parser.set_string_view_callback([](std::string_view s) {
+                if (s == "w0")
+                    throw std::invalid_argument("w0");
+                if (s.size() > 4u && s.substr(s.size() - 3u) == "000")
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            });
+            ParseParallel(parser, input, pool, 64u, order);
+            ASSERT(false);
+        } catch (const std::invalid_argument& e) {
+            ASSERT_EQUAL(std::string(e.what()), "w0");
+        }
+    }
+}
+
+void TestBatch() {
+    const std::string input = STREAM_INPUT + " 12\rab\v99999999999999999999 \t5";
+    Recorder expected;
+    expected.parser.run(input);
+
+    for (size_t capacity : {1u, 2u, 3u, 4096u}) {
+        std::vector<TokenKind> kinds(capacity);
+        std::vector<size_t> offsets(capacity), lengths(capacity);
+        std::vector<uint64_t> values(capacity);
+        TokenBatch batch{kinds.data(), offsets.data(), lengths.data(), values.data(), capacity};
+
+        std::string log = "<";
+        TokenBatcher batcher(input);
+        while (size_t count = batcher.next(batch)) {
+            ASSERT(count <= capacity);
+            for (size_t i = 0; i < count; i++) {
+                if (kinds[i] == TokenKind::NUMBER) {
+                    log += "n" + std::to_string(values[i]) + ",";
+                } else {
+                    ASSERT_EQUAL(values[i], 0u);
+                    log += "s" + input.substr(offsets[i], lengths[i]) + ",";
+                }
+            }
+        }
+        ASSERT_EQUAL(batcher.next(batch), 0u);
+        ASSERT_EQUAL(log + ">", expected.log);
+    }
+    {
+        TokenKind kind;
+        size_t offset, length;
+        uint64_t value;
+        TokenBatch batch{&kind, &offset, &length, &value, 1u};
+        TokenBatcher batcher("  \t");
+        ASSERT_EQUAL(batcher.next(batch), 0u);
+        TokenBatcher number(" 0042 ");
+        ASSERT_EQUAL(number.next(batch), 1u);
+        ASSERT(kind == TokenKind::NUMBER);
+        ASSERT_EQUAL(value, 42u);
+        ASSERT_EQUAL(offset, 1u);
+        ASSERT_EQUAL(length, 4u);
+    }
+}
+
+void TestDelimiters() {
+    using Csv = scanner::DelimiterSet<',', ';', '\n'>;
+    static_assert(Csv::contains(',') && !Csv::contains(' ') && !Csv::ONLY_SPACES);
+    static_assert(scanner::DefaultDelimiters::ONLY_SPACES);
+
+    std::mt19937 gen(42);
+    const std::string alphabet = "ab1 ,;\t\n\r";
+    std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+    for (size_t len = 0; len < 300; len++) {
+        std::string str(len, ' ');
+        for (char& ch : str)
+            ch = alphabet[pick(gen)];
+        const char* end = str.data() + str.size();
+        for (const char* pos = str.data(); pos != end; pos++) {
+            ASSERT(scanner::SkipSpaces<Csv>(pos, end) == scanner::scalar::SkipSpaces<Csv>(pos, end));
+            ASSERT(scanner::FindDelimiter<Csv>(pos, end) == scanner::scalar::FindDelimiter<Csv>(pos, end));
+        }
+        scanner::BasicScanner<Csv> scan(str.data(), end);
+        for (const char* pos = str.data(); pos != end; ) {
+            const char* start = scan.skip_spaces(pos);
+            ASSERT(start == scanner::scalar::SkipSpaces<Csv>(pos, end));
+            pos = scan.find_delimiter(start);
+            ASSERT(pos == scanner::scalar::FindDelimiter<Csv>(start, end));
+            // delimiters are not skipped with these
+            if (pos != end)
+                ++pos;
+        }
+    }
+
+    std::vector<std::string> tokens;
+    BasicTokenParser csv(NoCallback{},
+                         [&](uint64_t num) { tokens.push_back("n" + std::to_string(num)); },
+                         [&](std::string_view s) { tokens.push_back("s" + std::string(s)); },
+                         NoCallback{}, TokenSyntax<Csv>{});
+    csv.run("id,name;12 Main St\n7,John Smith,,42\r\n");
+    ASSERT_EQUAL(tokens, std::vector<std::string>({
+        "sid", "sname", "s12 Main St", "n7", "sJohn Smith", "s", "n42"
+    }));
+
+    // every delimiter other than a space closes a field, maybe an empty one
+    tokens.clear();
+    csv.run("a,,b");
+    ASSERT_EQUAL(tokens, std::vector<std::string>({"sa", "s", "sb"}));
+    tokens.clear();
+    csv.run(",a , ;b,\n,c,\n");
+    ASSERT_EQUAL(tokens, std::vector<std::string>({"s", "sa", "s", "sb", "s", "sc"}));
+
+    // CRLF lines: '\r' is a space before the delimiter, not part of the token
+    tokens.clear();
+    std::string log;
+    BasicTokenParser crlf(NoCallback{},
+                          Overloaded{
+                              [&](uint64_t num) { log += "u" + std::to_string(num) + ","; },
+                              [&](int64_t num) { log += "i" + std::to_string(num) + ","; },
+                              [&](double) { log += "d,"; }
+                          },
+                          [&](std::string_view s) { log += "s" + std::string(s) + ","; },
+                          NoCallback{}, TokenSyntax<scanner::DelimiterSet<','>, token_class::SIGNED>{});
+    crlf.run("42\r,-42\r,x \r, 7\r\n");
+    ASSERT_EQUAL(log, "u42,i-42,sx,u7,");
+    csv.run("1,-2\r\nab\r\n,\r\n");
+    ASSERT_EQUAL(tokens, std::vector<std::string>({"n1", "s-2", "sab", "s"}));
+
+    tokens.clear();
+    TokenStream stream(csv);
+    for (char ch : std::string("1,a b;22\n"))
+        stream.feed(std::string_view(&ch, 1u));
+    stream.finish();
+    ASSERT_EQUAL(tokens, std::vector<std::string>({"n1", "sa b", "n22"}));
+
+    // pieces split after delimiters give the fields of the whole input
+    ThreadPool pool(2u);
+    for (size_t len : {0u, 1u, 17u, 300u, 5000u}) {
+        std::string str(len, ' ');
+        for (char& ch : str)
+            ch = alphabet[pick(gen)];
+        tokens.clear();
+        csv.run(str);
+        const std::vector<std::string> expected = tokens;
+        for (size_t chunk : {1u, 2u, 7u, 64u}) {
+            tokens.clear();
+            TokenStream chunked(csv);
+            for (size_t pos = 0; pos < str.size(); pos += chunk)
+                chunked.feed(std::string_view(str).substr(pos, chunk));
+            chunked.finish();
+            ASSERT_EQUAL(tokens, expected);
+        }
+        tokens.clear();
+        ParseParallel(csv, str, pool, 5u);
+        ASSERT_EQUAL(tokens, expected);
+    }
+}
+
+void TestTokenClasses() {
+    const std::string input = "12 -12 +7 -9223372036854775808 9223372036854775808 -9223372036854775809 "
+                              "0x1f 0XfF 0x 0xg 1.5 -2e3 .5 +.25 inf nan +-1 - 1e999 0001\r2";
+    std::vector<std::string> tokens;
+    auto number = Overloaded{
+        [&](uint64_t num) { tokens.push_back("u" + std::to_string(num)); },
+        [&](int64_t num) { tokens.push_back("i" + std::to_string(num)); },
+        [&](double num) { tokens.push_back("d" + std::to_string(num)); }
+    };
+    auto string = [&](std::string_view s) { tokens.push_back("s" + std::string(s)); };
+    {
+        BasicTokenParser parser(NoCallback{}, number, string, NoCallback{},
+                                TokenSyntax<scanner::DefaultDelimiters,
+                                            token_class::SIGNED | token_class::HEX |
+                                            token_class::FLOAT>{});
+        parser.run(input);
+        ASSERT_EQUAL(tokens, std::vector<std::string>({
+            "u12", "i-12", "i7", "i-9223372036854775808", "u9223372036854775808",
+            "d-9223372036854775808.000000", "u31", "u255", "s0x", "s0xg", "d1.500000",
+            "d-2000.000000", "d0.500000", "d0.250000", "sinf", "snan", "s+-1", "s-",
+            "s1e999", "u1"
+        }));
+    }
+    {
+        tokens.clear();
+        BasicTokenParser parser(NoCallback{}, number, string, NoCallback{},
+                                TokenSyntax<scanner::DefaultDelimiters, token_class::SIGNED>{});
+        parser.run("-5 0x10 1.5");
+        ASSERT_EQUAL(tokens, std::vector<std::string>({"i-5", "s0x10", "s1.5"}));
+    }
+
+    std::string log;
+    TokenParser parser;
+    parser.set_number_callback([&](uint64_t num) { log += "u" + std::to_string(num) + ","; });
+    parser.set_string_view_callback([&](std::string_view s) {
+        log += "s";
+        log += s;
+        log += ",";
+    });
+    parser.run("-5 0x10 1.5 7");
+    ASSERT_EQUAL(log, "s-5,s0x10,s1.5,u7,");
+
+    log.clear();
+    parser.set_signed_callback([&](int64_t num) { log += "i" + std::to_string(num) + ","; });
+    parser.set_hex_numbers(true);
+    parser.run("-5 0x10 1.5 7");
+    ASSERT_EQUAL(log, "i-5,u16,s1.5,u7,");
+
+    log.clear();
+    parser.set_double_callback([&](double num) { log += "d" + std::to_string(num) + ","; });
+    parser.set_hex_numbers(false);
+    parser.run("-5 0x10 1.5 7");
+    ASSERT_EQUAL(log, "i-5,s0x10,d1.500000,u7,");
+
+    log.clear();
+    ThreadPool pool(2u);
+    ParseParallel(parser, "-5 0x10 1.5 7 -6 2.5", pool, 3u);
+    ASSERT_EQUAL(log, "i-5,s0x10,d1.500000,u7,i-6,d2.500000,");
+}
+
 int main() {
     TestRunner tr;
     RUN_TEST(tr, TestNullptr);
     RUN_TEST(tr, TestStartAndEnd);
     RUN_TEST(tr, TestInteger);
     RUN_TEST(tr, TestString);
+    RUN_TEST(tr, TestStringView);
+    RUN_TEST(tr, TestBasicTokenParser);
     RUN_TEST(tr, TestUsage);
+    RUN_TEST(tr, TestScanner);
+    RUN_TEST(tr, TestParseNumber);
+    RUN_TEST(tr, TestLongInput);
+    RUN_TEST(tr, TestStream);
+    RUN_TEST(tr, TestStreamDrivers);
+    RUN_TEST(tr, TestSplitChunks);
+    RUN_TEST(tr, TestParallel);
+    RUN_TEST(tr, TestParallelExceptions);
+    RUN_TEST(tr, TestBatch);
+    RUN_TEST(tr, TestDelimiters);
+    RUN_TEST(tr, TestTokenClasses);
 }
@@ -0,0 +1,200 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "matrix.h"
+#include "fixed_matrix.h"
+#include "parallel.h"
+
+namespace chr = std::chrono;
+
+// Every benchmark prints CSV rows of the form
+// benchmark,size,seconds,gops
+// for square size x size matrices, one operation is one multiply or add.
+// The transposes follow in a second table, with gbps, the bytes read
+// and written per second, in place of gops.
+// Rows marked (N threads) use MatrixPool(), their speedup over the serial
+// rows only shows scaling when the host has more than one core.
+
+namespace {
+
+constexpr size_t MIN_SIZE = 64u;
+constexpr size_t MAX_SIZE = 4096u;
+// the naive product takes minutes beyond this
+constexpr size_t MAX_NAIVE_SIZE = 512u;
+constexpr size_t MAX_TYPED_SIZE = 1024u;
+// 4x4 products per run of the small matrix benchmarks
+constexpr size_t SMALL_PRODUCTS = 1u << 16;
+constexpr double MIN_SECONDS = 0.2;
+
+// keeps results that are not printed from being optimized out
+volatile int32_t sink;
+
+template<class T = int32_t>
+BasicMatrix<T> Random(size_t size) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int32_t> dist(-100, 100);
+    BasicMatrix<T> m(size, size);
+    for (size_t i = 0; i < size; i++)
+        for (size_t j = 0; j < size; j++)
+            m.at(i, j) = static_cast<T>(dist(gen));
+    return m;
+}
+
+// i-k-j loop through at(), the product before the blocked kernel
+Matrix NaiveProduct(const Matrix& lhs, const Matrix& rhs) {
+    Matrix res(lhs.nrows(), rhs.ncols());
+    for (size_t i = 0; i < lhs.nrows(); i++)
+        for (size_t p = 0; p < lhs.ncols(); p++)
+            for (size_t j = 0; j < rhs.ncols(); j++)
+                res.at(i, j) += lhs.at(i, p) * rhs.at(p, j);
+    return res;
+}
+
+// Best time of runs adding up to at least MIN_SECONDS.
+template <typename Func>
+void Bench(const std::string& name, size_t size, double ops, Func func) {
+    double best = 0.0;
+    chr::duration<double> total{0.0};
+    for (size_t pass = 0; pass == 0u || total.count() < MIN_SECONDS; pass++) {
+        auto start = chr::steady_clock::now();
+        func();
+        chr::duration<double> dur = chr::steady_clock::now() - start;
+        total += dur;
+        if (pass == 0u || dur.count() < best)
+            best = dur.count();
+    }
+    std::cout << name << ',' << size << ',' << best << ',' << ops / best / 1e9 << std::endl;
+}
+
+// 4x4 transforms: stack FixedMatrix against heap Matrix
+void BenchSmall() {
+    using Mat4 = FixedMatrix<float, 4, 4>;
+    const double ops = 2.0 * 64.0 * SMALL_PRODUCTS;
+    Mat4 fixed({1, 0, 0, 1,  0, 1, 0, 2,  0, 0, 1, 3,  0, 0, 0, 1});
+    Bench("4x4 product (FixedMatrix)", 4, ops, [&] {
+        Mat4 acc = Mat4::Identity();
+        for (size_t i = 0; i < SMALL_PRODUCTS; i++)
+            acc = acc * fixed;
+        sink = static_cast<int32_t>(acc[0][3]);
+    });
+    BasicMatrix<float> dynamic = Random<float>(4);
+    Bench("4x4 product (BasicMatrix)", 4, ops, [&] {
+        BasicMatrix<float> acc = Random<float>(4);
+        for (size_t i = 0; i < SMALL_PRODUCTS; i++)
+            acc = acc * dynamic;
+        sink = static_cast<int32_t>(acc.at(0, 3));
+    });
+}
+
+// memcpy is the bound for moving the bytes, the naive loop
+// writes a new cache line for every element of a column
+template<class T>
+void BenchTranspose(const std::string& type, const std::string& threads) {
+    for (size_t size = MIN_SIZE; size <= MAX_SIZE; size *= 2u) {
+        const BasicMatrix<T> src = Random<T>(size);
+        BasicMatrix<T> dst(size, size);
+        BasicMatrix<T> square = src;
+        const double bytes = 2.0 * static_cast<double>(src.size() * sizeof(T));
+        Bench("memcpy " + type, size, bytes, [&] {
+            std::memcpy(dst.data(), src.data(), src.size() * sizeof(T));
+        });
+        Bench("naive transpose " + type, size, bytes, [&] {
+            for (size_t i = 0; i < size; i++)
+                for (size_t j = 0; j < size; j++)
+                    dst.data()[j * size + i] = src.data()[i * size + j];
+        });
+        Bench("blocked transpose " + type, size, bytes, [&] {
+            kernels::Transpose(src.data(), size, dst.data(), size, size, size);
+        });
+        Bench("transpose() in place " + type, size, bytes, [&] {
+            square.transpose();
+        });
+        Bench("transposed()" + threads + " " + type, size, bytes, [&] {
+            sink = static_cast<int32_t>(TransposeParallel(src).at(0, 0));
+        });
+    }
+}
+
+}  // namespace
+
+int main() {
+    // the calling thread works too
+    const std::string threads = " (" + std::to_string(MatrixPool().size() + 1u) + " threads)";
+    if (std::thread::hardware_concurrency() <= 1u)
+        std::cerr << "one hardware thread: the threaded rows do not show scaling\n";
+    std::cout << "benchmark,size,seconds,gops\n";
+    BenchSmall();
+    for (size_t size = MIN_SIZE; size <= MAX_SIZE; size *= 2u) {
+        Matrix lhs = Random(size);
+        Matrix rhs = Random(size);
+        const double n = static_cast<double>(size);
+
+        Bench("operator+", size, n * n, [&] {
+            sink = Matrix(lhs + rhs).at(0, 0);
+        });
+        Matrix res(size, size);
+        Bench("a + b + c + d (fused)", size, 3.0 * n * n, [&] {
+            res = lhs + rhs + lhs + rhs;
+        });
+        Bench("a + b + c + d (temporaries)", size, 3.0 * n * n, [&] {
+            Matrix ab = lhs + rhs;
+            Matrix abc = ab + lhs;
+            res = Matrix(abc + rhs);
+        });
+        Bench("operator*=", size, n * n, [&] {
+            lhs *= 1;
+        });
+        Bench("operator*=" + threads, size, n * n, [&] {
+            ScaleParallel(lhs, 1);
+        });
+        Bench("operator+" + threads, size, n * n, [&] {
+            AssignParallel(res, lhs + rhs);
+        });
+        Bench("operator*", size, 2.0 * n * n * n, [&] {
+            sink = (lhs * rhs).at(0, 0);
+        });
+        Bench("operator*" + threads, size, 2.0 * n * n * n, [&] {
+            sink = ProductParallel(lhs, rhs).at(0, 0);
+        });
+        Bench("sum via at()", size, n * n, [&] {
+            int32_t sum = 0;
+            for (size_t i = 0; i < size; i++)
+                for (size_t j = 0; j < size; j++)
+                    sum += lhs.at(i, j);
+            sink = sum;
+        });
+        Bench("sum via row()", size, n * n, [&] {
+            int32_t sum = 0;
+            for (size_t i = 0; i < size; i++)
+                for (int32_t el : lhs.row(i))
+                    sum += el;
+            sink = sum;
+        });
+        if (size <= MAX_TYPED_SIZE) {
+            BasicMatrix<double> dlhs = Random<double>(size);
+            BasicMatrix<double> drhs = Random<double>(size);
+            Bench("operator* double", size, 2.0 * n * n * n, [&] {
+                sink = static_cast<int32_t>((dlhs * drhs).at(0, 0));
+            });
+            BasicMatrix<float> flhs = Random<float>(size);
+            BasicMatrix<float> frhs = Random<float>(size);
+            Bench("operator* float", size, 2.0 * n * n * n, [&] {
+                sink = static_cast<int32_t>((flhs * frhs).at(0, 0));
+            });
+        }
+        if (size <= MAX_NAIVE_SIZE) {
+            Bench("naive product", size, 2.0 * n * n * n, [&] {
+                sink = NaiveProduct(lhs, rhs).at(0, 0);
+            });
+        }
+    }
+
+    std::cout << "\nbenchmark,size,seconds,gbps\n";
+    BenchTranspose<int32_t>("int32", threads);
+    BenchTranspose<double>("double", threads);
+}
@@ -0,0 +1,92 @@
+#ifndef FIXED_MATRIX_H
+#define FIXED_MATRIX_H
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include "kernels.h"
+
+// R x C matrix with the dimensions in the type, for small ones such as
+// 4x4 transforms. Lives on the stack, every operation is constexpr and
+// unrolled over the elements, so there are no loops left to run.
+// Integers wrap around as in BasicMatrix.
+template<class T, size_t R, size_t C>
+class FixedMatrix {
+    static_assert(kernels::IS_ELEMENT_TYPE<T>, "No kernels for the element type");
+    static_assert(R > 0 && C > 0, "Empty FixedMatrix");
+
+ public:
+    using value_type = T;
+    using Row = std::array<T, C>;
+
+    // zeros
+    constexpr FixedMatrix() = default;
+    // row by row: FixedMatrix<int32_t, 2, 2>({1, 2, 3, 4})
+    constexpr explicit FixedMatrix(const std::array<T, R * C>& elements);
+
+    static constexpr FixedMatrix Identity();
+    // res[i][j] = func(i, j)
+    template<class Func>
+    static constexpr FixedMatrix Generate(Func func);
+
+ public:
+    // unchecked, like std::array
+    constexpr const Row& operator[](size_t i) const { return rows_[i]; }
+    constexpr Row&       operator[](size_t i)       { return rows_[i]; }
+
+    constexpr T  at(size_t i, size_t j) const;
+    constexpr T& at(size_t i, size_t j);
+
+ public:
+    constexpr FixedMatrix& operator+=(const FixedMatrix& other);
+    constexpr FixedMatrix& operator-=(const FixedMatrix& other);
+    constexpr FixedMatrix& operator*=(T alpha);
+
+    constexpr FixedMatrix operator+(const FixedMatrix& other) const;
+    constexpr FixedMatrix operator-(const FixedMatrix& other) const;
+    constexpr FixedMatrix operator-() const;
+    constexpr FixedMatrix operator*(T alpha) const;
+    // (R x C) * (C x K)
+    template<size_t K>
+    constexpr FixedMatrix<T, R, K> operator*(const FixedMatrix<T, C, K>& other) const;
+
+    constexpr bool operator==(const FixedMatrix& other) const;
+    constexpr bool operator!=(const FixedMatrix& other) const;
+
+ public:
+    static constexpr size_t size()  { return R * C; }
+    static constexpr size_t nrows() { return R; }
+    static constexpr size_t ncols() { return C; }
+
+ private:
+    using Arith = kernels::Arith<T>;
+
+    template<class Func, size_t... Idx>
+    static constexpr FixedMatrix generate(Func& func, std::index_sequence<Idx...>);
+    template<size_t K, size_t... P>
+    static constexpr T dot(const FixedMatrix& lhs, const FixedMatrix<T, C, K>& rhs,
+                           size_t i, size_t j, std::index_sequence<P...>);
+
+ private:
+    std::array<Row, R> rows_{};
+};
+
+template<class T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C> operator*(T alpha, const FixedMatrix<T, R, C>& matr) {
+    return matr * alpha;
+}
+
+template<class T, size_t R, size_t C>
+std::ostream& operator<<(std::ostream& os, const FixedMatrix<T, R, C>& matr) {
+    for (size_t i = 0; i < R; ++i)
+        for (size_t j = 0; j < C; ++j)
+            os << matr[i][j] << " \n"[j == C - 1];
+    return os;
+}
+
+#include "fixed_matrix.tcc"
+
+#endif  // FIXED_MATRIX_H
@@ -0,0 +1,120 @@
+#ifndef FIXED_MATRIX_TCC
+#define FIXED_MATRIX_TCC
+
+#include <functional>
+
+#include "fixed_matrix.h"
+
+template<class T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C>::FixedMatrix(const std::array<T, R * C>& elements) {
+    *this = Generate([&](size_t i, size_t j) { return elements[i * C + j]; });
+}
+
+template<class T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C> FixedMatrix<T, R, C>::Identity() {
+    static_assert(R == C, "Identity of a non-square matrix");
+    return Generate([](size_t i, size_t j) { return static_cast<T>(i == j); });
+}
+
+template<class T, size_t R, size_t C>
+template<class Func>
+constexpr FixedMatrix<T, R, C> FixedMatrix<T, R, C>::Generate(Func func) {
+    return generate(func, std::make_index_sequence<R * C>());
+}
+
+template<class T, size_t R, size_t C>
+template<class Func, size_t... Idx>
+constexpr FixedMatrix<T, R, C> FixedMatrix<T, R, C>::generate(Func& func,
+                                                              std::index_sequence<Idx...>) {
+    FixedMatrix res;
+    ((res.rows_[Idx / C][Idx % C] = func(Idx / C, Idx % C)), ...);
+    return res;
+}
+
+template<class T, size_t R, size_t C>
+constexpr T FixedMatrix<T, R, C>::at(size_t i, size_t j) const {
+    if (i >= R || j >= C)
+        throw std::out_of_range("Bad indices");
+    return rows_[i][j];
+}
+
+template<class T, size_t R, size_t C>
+constexpr T& FixedMatrix<T, R, C>::at(size_t i, size_t j) {
+    if (i >= R || j >= C)
+        throw std::out_of_range("Bad indices");
+    return rows_[i][j];
+}
+
+template<class T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C>& FixedMatrix<T, R, C>::operator+=(const FixedMatrix& other) {
+    return *this = *this + other;
+}
+
+template<class T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C>& FixedMatrix<T, R, C>::operator-=(const FixedMatrix& other) {
+    return *this = *this - other;
+}
+
+template<class T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C>& FixedMatrix<T, R, C>::operator*=(T alpha) {
+    return *this = *this * alpha;
+}
+
+template<class T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C> FixedMatrix<T, R, C>::operator+(const FixedMatrix& other) const {
+    return Generate([&](size_t i, size_t j) {
+        return static_cast<T>(static_cast<Arith>(rows_[i][j]) + static_cast<Arith>(other[i][j]));
+    });
+}
+
+template<class T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C> FixedMatrix<T, R, C>::operator-(const FixedMatrix& other) const {
+    return Generate([&](size_t i, size_t j) {
+        return static_cast<T>(static_cast<Arith>(rows_[i][j]) - static_cast<Arith>(other[i][j]));
+    });
+}
+
+template<class T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C> FixedMatrix<T, R, C>::operator-() const {
+    return *this * static_cast<T>(-1);
+}
+
+template<class T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C> FixedMatrix<T, R, C>::operator*(T alpha) const {
+    return Generate([&](size_t i, size_t j) {
+        return static_cast<T>(static_cast<Arith>(rows_[i][j]) * static_cast<Arith>(alpha));
+    });
+}
+
+template<class T, size_t R, size_t C>
+template<size_t K, size_t... P>
+constexpr T FixedMatrix<T, R, C>::dot(const FixedMatrix& lhs, const FixedMatrix<T, C, K>& rhs,
+                                      size_t i, size_t j, std::index_sequence<P...>) {
+    return static_cast<T>((Arith{} + ... + (static_cast<Arith>(lhs[i][P]) *
+                                            static_cast<Arith>(rhs[P][j]))));
+}
+
+template<class T, size_t R, size_t C>
+template<size_t K>
+constexpr FixedMatrix<T, R, K> FixedMatrix<T, R, C>::operator*(
+    const FixedMatrix<T, C, K>& other) const {
+    return FixedMatrix<T, R, K>::Generate([&](size_t i, size_t j) {
+        return dot(*this, other, i, j, std::make_index_sequence<C>());
+    });
+}
+
+template<class T, size_t R, size_t C>
+constexpr bool FixedMatrix<T, R, C>::operator==(const FixedMatrix& other) const {
+    for (size_t i = 0; i < R; ++i)
+        for (size_t j = 0; j < C; ++j)
+            if (!std::equal_to<T>()(rows_[i][j], other[i][j]))
+                return false;
+    return true;
+}
+
+template<class T, size_t R, size_t C>
+constexpr bool FixedMatrix<T, R, C>::operator!=(const FixedMatrix& other) const {
+    return !(*this == other);
+}
+
+#endif  // FIXED_MATRIX_TCC
@@ -0,0 +1,339 @@
+#include <algorithm>
+#include <memory>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "kernels.h"
+
+namespace kernels {
+
+namespace {
+
+// b[p][j] for p < kc, j < nc into strips of GEMM_NR columns,
+// the last strip is padded with zeros
+template<class T>
+void PackB(const T* b, size_t ldb, size_t kc, size_t nc, T* packed) {
+    for (size_t j = 0; j < nc; j += GEMM_NR) {
+        const size_t nr = std::min(GEMM_NR, nc - j);
+        for (size_t p = 0; p < kc; p++) {
+            const T* row = b + p * ldb + j;
+            std::copy(row, row + nr, packed);
+            std::fill(packed + nr, packed + GEMM_NR, T{});
+            packed += GEMM_NR;
+        }
+    }
+}
+
+// c[i][j] += sum over p of a[i][p] * bp[p][j] for i < MR, j < nr
+template<size_t MR, class T>
+void MicroKernel(size_t kc, const T* a, size_t lda, const T* bp, T* c, size_t ldc, size_t nr) {
+    Arith<T> acc[MR][GEMM_NR] = {};
+    for (size_t p = 0; p < kc; p++, bp += GEMM_NR) {
+        for (size_t i = 0; i < MR; i++) {
+            const Arith<T> ai = a[i * lda + p];
+            for (size_t j = 0; j < GEMM_NR; j++)
+                acc[i][j] += ai * static_cast<Arith<T>>(bp[j]);
+        }
+    }
+    for (size_t i = 0; i < MR; i++)
+        for (size_t j = 0; j < nr; j++)
+            c[i * ldc + j] = static_cast<T>(static_cast<Arith<T>>(c[i * ldc + j]) + acc[i][j]);
+}
+
+#if defined(__AVX2__)
+
+// AVX2 registers of T: WIDTH lanes, madd(acc, a, b) is acc + a * b.
+// None for int64_t, AVX2 has no 64-bit multiply.
+template<class T>
+struct Lanes {
+    static constexpr size_t WIDTH = 0u;
+};
+
+template<>
+struct Lanes<int32_t> {
+    using Vec = __m256i;
+    static constexpr size_t WIDTH = 8u;
+    static Vec zero() { return _mm256_setzero_si256(); }
+    static Vec broadcast(int32_t value) { return _mm256_set1_epi32(value); }
+    static Vec load(const int32_t* ptr) {
+        return _mm256_loadu_si256(reinterpret_cast<const Vec*>(ptr));
+    }
+    static void store(int32_t* ptr, Vec v) {
+        _mm256_storeu_si256(reinterpret_cast<Vec*>(ptr), v);
+    }
+    static Vec add(Vec a, Vec b) { return _mm256_add_epi32(a, b); }
+    static Vec madd(Vec acc, Vec a, Vec b) {
+        return _mm256_add_epi32(acc, _mm256_mullo_epi32(a, b));
+    }
+};
+
+template<>
+struct Lanes<float> {
+    using Vec = __m256;
+    static constexpr size_t WIDTH = 8u;
+    static Vec zero() { return _mm256_setzero_ps(); }
+    static Vec broadcast(float value) { return _mm256_set1_ps(value); }
+    static Vec load(const float* ptr) { return _mm256_loadu_ps(ptr); }
+    static void store(float* ptr, Vec v) { _mm256_storeu_ps(ptr, v); }
+    static Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+#if defined(__FMA__)
+    static Vec madd(Vec acc, Vec a, Vec b) { return _mm256_fmadd_ps(a, b, acc); }
+#else
+    static Vec madd(Vec acc, Vec a, Vec b) { return _mm256_add_ps(acc, _mm256_mul_ps(a, b)); }
+#endif
+};
+
+template<>
+struct Lanes<double> {
+    using Vec = __m256d;
+    static constexpr size_t WIDTH = 4u;
+    static Vec zero() { return _mm256_setzero_pd(); }
+    static Vec broadcast(double value) { return _mm256_set1_pd(value); }
+    static Vec load(const double* ptr) { return _mm256_loadu_pd(ptr); }
+    static void store(double* ptr, Vec v) { _mm256_storeu_pd(ptr, v); }
+    static Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+#if defined(__FMA__)
+    static Vec madd(Vec acc, Vec a, Vec b) { return _mm256_fmadd_pd(a, b, acc); }
+#else
+    static Vec madd(Vec acc, Vec a, Vec b) { return _mm256_add_pd(acc, _mm256_mul_pd(a, b)); }
+#endif
+};
+
+template<size_t MR, class T, class L = Lanes<T>>
+void VectorMicroKernel(size_t kc, const T* a, size_t lda, const T* bp,
+                       T* c, size_t ldc, size_t nr) {
+    constexpr size_t NV = GEMM_NR / L::WIDTH;
+    typename L::Vec acc[MR][NV];
+    for (size_t i = 0; i < MR; i++)
+        for (size_t v = 0; v < NV; v++)
+            acc[i][v] = L::zero();
+    for (size_t p = 0; p < kc; p++, bp += GEMM_NR) {
+        typename L::Vec b[NV];
+        for (size_t v = 0; v < NV; v++)
+            b[v] = L::load(bp + v * L::WIDTH);
+        for (size_t i = 0; i < MR; i++) {
+            const typename L::Vec ai = L::broadcast(a[i * lda + p]);
+            for (size_t v = 0; v < NV; v++)
+                acc[i][v] = L::madd(acc[i][v], ai, b[v]);
+        }
+    }
+    for (size_t i = 0; i < MR; i++) {
+        T* row = c + i * ldc;
+        if (nr == GEMM_NR) {
+            for (size_t v = 0; v < NV; v++)
+                L::store(row + v * L::WIDTH, L::add(L::load(row + v * L::WIDTH), acc[i][v]));
+        } else {
+            T tile[GEMM_NR];
+            for (size_t v = 0; v < NV; v++)
+                L::store(tile + v * L::WIDTH, acc[i][v]);
+            for (size_t j = 0; j < nr; j++)
+                row[j] = static_cast<T>(static_cast<Arith<T>>(row[j]) +
+                                        static_cast<Arith<T>>(tile[j]));
+        }
+    }
+}
+
+#endif
+
+// the AVX2 kernel where T has Lanes, the plain one otherwise
+template<size_t MR, class T>
+void Tile(size_t kc, const T* a, size_t lda, const T* bp, T* c, size_t ldc, size_t nr) {
+#if defined(__AVX2__)
+    if constexpr (Lanes<T>::WIDTH != 0u) {
+        VectorMicroKernel<MR>(kc, a, lda, bp, c, ldc, nr);
+        return;
+    }
+#endif
+    MicroKernel<MR>(kc, a, lda, bp, c, ldc, nr);
+}
+
+// 8x8 block dst = src^T, dst may be src itself
+template<class T>
+void PlainTranspose8x8(const T* src, size_t lds, T* dst, size_t ldd) {
+    T tile[8][8];
+    for (size_t i = 0; i < 8; i++)
+        for (size_t j = 0; j < 8; j++)
+            tile[j][i] = src[i * lds + j];
+    for (size_t i = 0; i < 8; i++)
+        std::copy(tile[i], tile[i] + 8, dst + i * ldd);
+}
+
+#if defined(__AVX2__)
+
+// 32-bit lanes moved as floats: unpack pairs of rows, shuffle pairs of
+// pairs, then swap the 128-bit halves
+void VectorTranspose8x8(const float* src, size_t lds, float* dst, size_t ldd) {
+    __m256 r[8], t[8];
+    for (size_t i = 0; i < 8; i++)
+        r[i] = _mm256_loadu_ps(src + i * lds);
+    for (size_t i = 0; i < 8; i += 2) {
+        t[i]     = _mm256_unpacklo_ps(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+    }
+    for (size_t i = 0; i < 8; i += 4) {
+        r[i]     = _mm256_shuffle_ps(t[i],     t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+        r[i + 1] = _mm256_shuffle_ps(t[i],     t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+        r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+        r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+    }
+    for (size_t i = 0; i < 4; i++) {
+        _mm256_storeu_ps(dst + i * ldd,       _mm256_permute2f128_ps(r[i], r[i + 4], 0x20));
+        _mm256_storeu_ps(dst + (i + 4) * ldd, _mm256_permute2f128_ps(r[i], r[i + 4], 0x31));
+    }
+}
+
+// 64-bit lanes moved as doubles: four 4x4 quadrants, swapped across the
+// diagonal; every load happens before the first store
+void VectorTranspose8x8(const double* src, size_t lds, double* dst, size_t ldd) {
+    __m256d r[8][2];
+    for (size_t i = 0; i < 8; i++) {
+        r[i][0] = _mm256_loadu_pd(src + i * lds);
+        r[i][1] = _mm256_loadu_pd(src + i * lds + 4);
+    }
+    for (size_t qi = 0; qi < 8; qi += 4) {
+        for (size_t half = 0; half < 2; half++) {
+            const __m256d t0 = _mm256_unpacklo_pd(r[qi][half],     r[qi + 1][half]);
+            const __m256d t1 = _mm256_unpackhi_pd(r[qi][half],     r[qi + 1][half]);
+            const __m256d t2 = _mm256_unpacklo_pd(r[qi + 2][half], r[qi + 3][half]);
+            const __m256d t3 = _mm256_unpackhi_pd(r[qi + 2][half], r[qi + 3][half]);
+            // column 4 * half + c of source rows qi..qi + 3
+            double* out = dst + 4 * half * ldd + qi;
+            _mm256_storeu_pd(out,           _mm256_permute2f128_pd(t0, t2, 0x20));
+            _mm256_storeu_pd(out + ldd,     _mm256_permute2f128_pd(t1, t3, 0x20));
+            _mm256_storeu_pd(out + 2 * ldd, _mm256_permute2f128_pd(t0, t2, 0x31));
+            _mm256_storeu_pd(out + 3 * ldd, _mm256_permute2f128_pd(t1, t3, 0x31));
+        }
+    }
+}
+
+#endif
+
+template<class T>
+void Transpose8x8(const T* src, size_t lds, T* dst, size_t ldd) {
+#if defined(__AVX2__)
+    using Lane = std::conditional_t<sizeof(T) == 4u, float, double>;
+    VectorTranspose8x8(reinterpret_cast<const Lane*>(src), lds,
+                       reinterpret_cast<Lane*>(dst), ldd);
+#else
+    PlainTranspose8x8(src, lds, dst, ldd);
+#endif
+}
+
+}  // namespace
+
+template<class T>
+void Scale(T* data, size_t n, T alpha) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    if constexpr (std::is_same_v<T, int32_t>) {
+        const __m256i valpha = _mm256_set1_epi32(alpha);
+        for (; i + 8 <= n; i += 8) {
+            __m256i* dst = reinterpret_cast<__m256i*>(data + i);
+            _mm256_storeu_si256(dst, _mm256_mullo_epi32(_mm256_loadu_si256(dst), valpha));
+        }
+    }
+#endif
+    for (; i < n; i++)
+        data[i] = static_cast<T>(static_cast<Arith<T>>(data[i]) * static_cast<Arith<T>>(alpha));
+}
+
+template<class T>
+void Transpose(const T* src, size_t lds, T* dst, size_t ldd, size_t rows, size_t cols) {
+    const size_t rows8 = rows / 8u * 8u;
+    const size_t cols8 = cols / 8u * 8u;
+    for (size_t i0 = 0; i0 < rows8; i0 += TRANSPOSE_TILE) {
+        const size_t i1 = std::min(i0 + TRANSPOSE_TILE, rows8);
+        for (size_t j0 = 0; j0 < cols8; j0 += TRANSPOSE_TILE) {
+            const size_t j1 = std::min(j0 + TRANSPOSE_TILE, cols8);
+            for (size_t i = i0; i < i1; i += 8u)
+                for (size_t j = j0; j < j1; j += 8u)
+                    Transpose8x8(src + i * lds + j, lds, dst + j * ldd + i, ldd);
+        }
+    }
+    // ragged edges: the last cols % 8 columns, then the last rows % 8 rows
+    for (size_t i = 0; i < rows8; i++)
+        for (size_t j = cols8; j < cols; j++)
+            dst[j * ldd + i] = src[i * lds + j];
+    for (size_t i = rows8; i < rows; i++)
+        for (size_t j = 0; j < cols; j++)
+            dst[j * ldd + i] = src[i * lds + j];
+}
+
+template<class T>
+void TransposeInPlace(T* data, size_t n) {
+    const size_t n8 = n / 8u * 8u;
+    T tile[8 * 8];
+    // 8x8 blocks of the upper triangle, tile by tile; a block
+    // above the diagonal is swapped with its mirror below it
+    for (size_t i0 = 0; i0 < n8; i0 += TRANSPOSE_TILE) {
+        const size_t i1 = std::min(i0 + TRANSPOSE_TILE, n8);
+        for (size_t j0 = i0; j0 < n8; j0 += TRANSPOSE_TILE) {
+            const size_t j1 = std::min(j0 + TRANSPOSE_TILE, n8);
+            for (size_t i = i0; i < i1; i += 8u) {
+                for (size_t j = std::max(j0, i); j < j1; j += 8u) {
+                    T* upper = data + i * n + j;
+                    if (i == j) {
+                        Transpose8x8(upper, n, upper, n);
+                        continue;
+                    }
+                    T* lower = data + j * n + i;
+                    Transpose8x8(upper, n, tile, 8u);
+                    Transpose8x8(lower, n, upper, n);
+                    for (size_t r = 0; r < 8u; r++)
+                        std::copy(tile + r * 8u, tile + r * 8u + 8u, lower + r * n);
+                }
+            }
+        }
+    }
+    // pairs with an index in the last n % 8 rows and columns
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = std::max(i + 1u, n8); j < n; j++)
+            std::swap(data[i * n + j], data[j * n + i]);
+}
+
+template<class T>
+void Gemm(const T* a, const T* b, T* c, size_t m, size_t n, size_t k) {
+    if (m == 0 || n == 0 || k == 0)
+        return;
+    std::unique_ptr<T[]> packed(new T[GEMM_KC * GEMM_NC]);
+    for (size_t jc = 0; jc < n; jc += GEMM_NC) {
+        const size_t nc = std::min(GEMM_NC, n - jc);
+        for (size_t pc = 0; pc < k; pc += GEMM_KC) {
+            const size_t kc = std::min(GEMM_KC, k - pc);
+            PackB(b + pc * n + jc, n, kc, nc, packed.get());
+            for (size_t i = 0; i < m; i += GEMM_MR) {
+                const T* ap = a + i * k + pc;
+                for (size_t j = 0; j < nc; j += GEMM_NR) {
+                    // strips of kc x GEMM_NR follow each other
+                    const T* bp = packed.get() + j * kc;
+                    T* cp = c + i * n + jc + j;
+                    const size_t nr = std::min(GEMM_NR, nc - j);
+                    switch (std::min(GEMM_MR, m - i)) {
+                        case 4: Tile<4>(kc, ap, k, bp, cp, n, nr); break;
+                        case 3: Tile<3>(kc, ap, k, bp, cp, n, nr); break;
+                        case 2: Tile<2>(kc, ap, k, bp, cp, n, nr); break;
+                        default: Tile<1>(kc, ap, k, bp, cp, n, nr); break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+#define KERNELS_INSTANTIATE(T)                                                  \
+    template void Scale<T>(T* data, size_t n, T alpha);                         \
+    template void Transpose<T>(const T* src, size_t lds, T* dst, size_t ldd,    \
+                               size_t rows, size_t cols);                       \
+    template void TransposeInPlace<T>(T* data, size_t n);                       \
+    template void Gemm<T>(const T* a, const T* b, T* c, size_t m, size_t n, size_t k)
+
+KERNELS_INSTANTIATE(int32_t);
+KERNELS_INSTANTIATE(int64_t);
+KERNELS_INSTANTIATE(float);
+KERNELS_INSTANTIATE(double);
+
+#undef KERNELS_INSTANTIATE
+
+}  // namespace kernels
@@ -0,0 +1,52 @@
+#ifndef MATRIX_KERNELS_H
+#define MATRIX_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Loops over the storage of BasicMatrix, built for the element types below.
+// AVX2 versions are used for int32_t, float and double when the target has
+// it (-mavx2, -march=native), plain loops the compiler vectorizes otherwise.
+// Integer arithmetic wraps around modulo 2^bits.
+namespace kernels {
+
+template<class T>
+constexpr bool IS_ELEMENT_TYPE = std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t> ||
+                                 std::is_same_v<T, float>   || std::is_same_v<T, double>;
+
+// Type to compute T in: the unsigned counterpart of integers, T itself otherwise
+template<class T>
+using Arith = typename std::conditional_t<std::is_integral_v<T>,
+                                          std::make_unsigned<T>, std::common_type<T>>::type;
+
+// data[i] *= alpha
+template<class T>
+void Scale(T* data, size_t n, T alpha);
+
+// dst[j * ldd + i] = src[i * lds + j] for i < rows, j < cols.
+// Walks TRANSPOSE_TILE x TRANSPOSE_TILE tiles, so that the rows of both
+// stay in L1, in 8x8 blocks transposed in registers.
+template<class T>
+void Transpose(const T* src, size_t lds, T* dst, size_t ldd, size_t rows, size_t cols);
+
+// Transpose of the row-major n x n matrix data, in place
+template<class T>
+void TransposeInPlace(T* data, size_t n);
+
+// c += a * b for row-major a (m x k), b (k x n) and c (m x n).
+// Blocked for the caches: a panel of b is packed into strips of
+// GEMM_NR columns, each GEMM_MR x GEMM_NR tile of c is kept in registers.
+template<class T>
+void Gemm(const T* a, const T* b, T* c, size_t m, size_t n, size_t k);
+
+constexpr size_t GEMM_MR = 4u;
+constexpr size_t GEMM_NR = 16u;
+constexpr size_t GEMM_KC = 256u;
+constexpr size_t GEMM_NC = 256u;
+
+constexpr size_t TRANSPOSE_TILE = 32u;
+
+}  // namespace kernels
+
+#endif  // MATRIX_KERNELS_H
@@ -1,40 +1,223 @@
 #ifndef MATRIX_H
 #define MATRIX_H
 
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <memory>
 #include <iostream>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+#include "kernels.h"
+#include "matrix_expr.h"
+
+// Storage alignment of BasicMatrix, a cache line
+constexpr size_t MATRIX_ALIGNMENT = 64u;
+
+// Element (i, j) is at i * ncols + j
+struct RowMajor {
+    static size_t index(size_t i, size_t j, size_t, size_t ncols) { return i * ncols + j; }
+};
+
+// Element (i, j) is at j * nrows + i
+struct ColMajor {
+    static size_t index(size_t i, size_t j, size_t nrows, size_t) { return j * nrows + i; }
+};
+
+// Bounds-check policies of row(), col() and the views, chosen by the caller
+struct Unchecked {
+    static void check(size_t, size_t) {}
+};
+
+struct Checked {
+    static void check(size_t idx, size_t size) {
+        if (idx >= size)
+            throw std::out_of_range("Bad indices");
+    }
+};
+
+// Checked in debug builds, Unchecked otherwise. The library never names it:
+// code built with -DDEBUG gets other instantiations than a release libmatrix,
+// not other bodies of the same ones.
+#if defined(DEBUG)
+using DebugChecked = Checked;
+#else
+using DebugChecked = Unchecked;
+#endif
+
+// Pointer and length of one contiguous line of a matrix: a row of a
+// row-major one or a column of a column-major one, like std::span.
+template<class T, class Check = Unchecked>
+class RowView {
+ public:
+    RowView(T* data, size_t size)
+        : data_(data), size_(size) {}
+
+    // operator[] checks as the Check policy says, at() always throws std::out_of_range
+    T& operator[](size_t j) const;
+    T& at(size_t j) const;
+
+    T* data() const  { return data_; }
+    size_t size() const { return size_; }
+    T* begin() const { return data_; }
+    T* end()   const { return data_ + size_; }
+
+ private:
+    T* data_;
+    size_t size_;
+};
+
+// Pointer, stride and length of a line of a matrix across its storage
+// order: a column of a row-major matrix or a row of a column-major one.
+// Element j is data[j * stride], writes go to the matrix.
+template<class T, class Check = Unchecked>
+class StridedView {
+ public:
+    class Iterator {
+     public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = std::remove_const_t<T>;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = T*;
+        using reference         = T&;
+
+        Iterator(T* data, size_t stride, size_t j)
+            : data_(data), stride_(stride), j_(j) {}
+
+        T& operator*() const { return data_[j_ * stride_]; }
+        Iterator& operator++() { ++j_; return *this; }
+        Iterator operator++(int) { Iterator old = *this; ++j_; return old; }
+        bool operator==(const Iterator& other) const { return j_ == other.j_; }
+        bool operator!=(const Iterator& other) const { return j_ != other.j_; }
+
+     private:
+        T* data_;
+        size_t stride_;
+        size_t j_;
+    };
+
+    StridedView(T* data, size_t stride, size_t size)
+        : data_(data), stride_(stride), size_(size) {}
+
+    // operator[] checks as the Check policy says, at() always throws std::out_of_range
+    T& operator[](size_t j) const;
+    T& at(size_t j) const;
+
+    T* data() const  { return data_; }
+    size_t stride() const { return stride_; }
+    size_t size() const { return size_; }
+    Iterator begin() const { return {data_, stride_, 0u}; }
+    Iterator end()   const { return {data_, stride_, size_}; }
+
+ private:
+    T* data_;
+    size_t stride_;
+    size_t size_;
+};
+
+// Dense matrix of int32_t, int64_t, float or double, stored in one
+// MATRIX_ALIGNMENT-aligned block in the Layout order.
+template<class T, class Layout = RowMajor>
+class BasicMatrix : public MatrixExpr<BasicMatrix<T, Layout>> {
+    static_assert(kernels::IS_ELEMENT_TYPE<T>, "No kernels for the element type");
+    static_assert(std::is_same_v<Layout, RowMajor> || std::is_same_v<Layout, ColMajor>,
+                  "Layout is RowMajor or ColMajor");
 
-class Matrix {
  public:
-    Matrix(size_t nrows, size_t ncols);
+    using value_type  = T;
+    using layout_type = Layout;
+
+    BasicMatrix(size_t nrows, size_t ncols);
+    // evaluates the expression in one pass
+    template<class E>
+    BasicMatrix(const MatrixExpr<E>& expr);
 
-    Matrix(const Matrix&);
-    Matrix& operator=(const Matrix&);
+    BasicMatrix(const BasicMatrix&);
+    BasicMatrix& operator=(const BasicMatrix&);
 
-    Matrix(Matrix&&);
-    Matrix& operator=(Matrix&&);
+    BasicMatrix(BasicMatrix&&);
+    BasicMatrix& operator=(BasicMatrix&&);
+
+    // A copy of the matrix in the other layout, its storage transposed by
+    // the Transpose kernel, so O(size). Writes to one are not seen by the
+    // other; row() and col() are the views.
+    template<class Other, class = std::enable_if_t<!std::is_same_v<Other, Layout>>>
+    explicit BasicMatrix(const BasicMatrix<T, Other>& other);
+
+    template<class E>
+    BasicMatrix& operator=(const MatrixExpr<E>& expr);
 
  public:
     struct Proxy {
-        const Matrix& matrix;
+        const BasicMatrix& matrix;
         size_t i;
 
-        int32_t  operator[](size_t j) const;
-        int32_t& operator[](size_t j);
+        T  operator[](size_t j) const;
+        T& operator[](size_t j);
     };
 
     const Proxy operator[](size_t i) const;
     Proxy operator[](size_t i);
 
-    int32_t  at(size_t i, size_t j) const;
-    int32_t& at(size_t i, size_t j);
+    T  at(size_t i, size_t j) const;
+    T& at(size_t i, size_t j);
+
+    // element idx of the storage, for expression nodes
+    T element(size_t idx) const;
+
+    // Views of the matrix for hot loops: lines along the storage order (rows
+    // of a row-major one) are contiguous RowViews, the others StridedViews.
+    // Check is the bounds-check policy of the index and of the view's
+    // operator[]: row(i) checks nothing, row<DebugChecked>(i) only in debug
+    // builds, row<Checked>(i) always.
+    template<class Check = Unchecked>
+    using Row      = std::conditional_t<std::is_same_v<Layout, RowMajor>,
+                                        RowView<T, Check>, StridedView<T, Check>>;
+    template<class Check = Unchecked>
+    using ConstRow = std::conditional_t<std::is_same_v<Layout, RowMajor>,
+                                        RowView<const T, Check>, StridedView<const T, Check>>;
+    template<class Check = Unchecked>
+    using Col      = std::conditional_t<std::is_same_v<Layout, ColMajor>,
+                                        RowView<T, Check>, StridedView<T, Check>>;
+    template<class Check = Unchecked>
+    using ConstCol = std::conditional_t<std::is_same_v<Layout, ColMajor>,
+                                        RowView<const T, Check>, StridedView<const T, Check>>;
+
+    template<class Check = Unchecked>
+    Row<Check>      row(size_t i);
+    template<class Check = Unchecked>
+    ConstRow<Check> row(size_t i) const;
+    template<class Check = Unchecked>
+    Col<Check>      col(size_t j);
+    template<class Check = Unchecked>
+    ConstCol<Check> col(size_t j) const;
+
+    // nrows() * ncols() elements in the Layout order
+    T*       data();
+    const T* data() const;
 
  public:
-    Matrix  operator+(const Matrix& other) const;
-    Matrix& operator*=(int32_t alpha);
+    // + - and scalar * build expressions, see matrix_expr.h
+    template<class E>
+    BasicMatrix& operator+=(const MatrixExpr<E>& expr);
+    template<class E>
+    BasicMatrix& operator-=(const MatrixExpr<E>& expr);
+    BasicMatrix& operator*=(T alpha);
+    // (nrows x k) * (k x ncols), blocked GEMM; a hidden friend,
+    // so that expressions convert to matrix operands
+    friend BasicMatrix operator*(const BasicMatrix& lhs, const BasicMatrix& rhs) {
+        return product(lhs, rhs);
+    }
 
-    bool operator==(const Matrix& other) const;
-    bool operator!=(const Matrix& other) const;
+    // ncols x nrows, in the same layout
+    BasicMatrix transposed() const;
+    // in place for square matrices, through transposed() otherwise
+    BasicMatrix& transpose();
+
+    bool operator==(const BasicMatrix& other) const;
+    bool operator!=(const BasicMatrix& other) const;
 
  public:
     size_t size()  const;
@@ -42,15 +225,43 @@ class Matrix {
     size_t ncols() const;
 
  private:
+    // operator new[] only aligns to alignof(T)
+    struct AlignedDelete {
+        void operator()(T* ptr) const;
+    };
+    using Storage = std::unique_ptr<T[], AlignedDelete>;
+
+    static Storage allocate(size_t size);
+    static BasicMatrix product(const BasicMatrix& lhs, const BasicMatrix& rhs);
+
     void is_indices_valid(size_t i, size_t j) const;
+    size_t index(size_t i, size_t j) const;
+
+    template<class E, class Op>
+    void assign(const MatrixExpr<E>& expr, Op op);
 
  private:
     size_t nrows_ = 0ul;
     size_t ncols_ = 0ul;
-    std::unique_ptr<int32_t[]> data_;
+    Storage data_;
 };
 
-std::ostream& operator<<(std::ostream& os, const Matrix&);
-std::istream& operator>>(std::istream& is, Matrix&);
+using Matrix = BasicMatrix<int32_t>;
+
+template<class T, class Layout>
+std::ostream& operator<<(std::ostream& os, const BasicMatrix<T, Layout>&);
+template<class T, class Layout>
+std::istream& operator>>(std::istream& is, BasicMatrix<T, Layout>&);
+
+#include "matrix.tcc"
+
+extern template class BasicMatrix<int32_t, RowMajor>;
+extern template class BasicMatrix<int64_t, RowMajor>;
+extern template class BasicMatrix<float,   RowMajor>;
+extern template class BasicMatrix<double,  RowMajor>;
+extern template class BasicMatrix<int32_t, ColMajor>;
+extern template class BasicMatrix<int64_t, ColMajor>;
+extern template class BasicMatrix<float,   ColMajor>;
+extern template class BasicMatrix<double,  ColMajor>;
 
 #endif  // MATRIX_H
@@ -0,0 +1,332 @@
+#ifndef MATRIX_TCC
+#define MATRIX_TCC
+
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "matrix.h"
+
+template<class T, class Check>
+T& RowView<T, Check>::operator[](size_t j) const {
+    Check::check(j, size_);
+    return data_[j];
+}
+
+template<class T, class Check>
+T& RowView<T, Check>::at(size_t j) const {
+    Checked::check(j, size_);
+    return data_[j];
+}
+
+template<class T, class Check>
+T& StridedView<T, Check>::operator[](size_t j) const {
+    Check::check(j, size_);
+    return data_[j * stride_];
+}
+
+template<class T, class Check>
+T& StridedView<T, Check>::at(size_t j) const {
+    Checked::check(j, size_);
+    return data_[j * stride_];
+}
+
+template<class T, class Layout>
+void BasicMatrix<T, Layout>::AlignedDelete::operator()(T* ptr) const {
+    ::operator delete[](ptr, std::align_val_t(MATRIX_ALIGNMENT));
+}
+
+template<class T, class Layout>
+typename BasicMatrix<T, Layout>::Storage BasicMatrix<T, Layout>::allocate(size_t size) {
+    void* raw = ::operator new[](size * sizeof(T), std::align_val_t(MATRIX_ALIGNMENT));
+    T* ptr = static_cast<T*>(raw);
+    std::uninitialized_fill_n(ptr, size, T{});
+    return Storage(ptr);
+}
+
+template<class T, class Layout>
+BasicMatrix<T, Layout>::BasicMatrix(size_t nrows, size_t ncols)
+    : nrows_(nrows)
+    , ncols_(ncols)
+    , data_(allocate(nrows_ * ncols_)) {}
+
+template<class T, class Layout>
+BasicMatrix<T, Layout>::BasicMatrix(const BasicMatrix& other)
+    : nrows_(other.nrows_)
+    , ncols_(other.ncols_)
+    , data_(allocate(nrows_ * ncols_)) {
+    std::copy(other.data_.get(), other.data_.get() + size(), data_.get());
+}
+
+template<class T, class Layout>
+BasicMatrix<T, Layout>& BasicMatrix<T, Layout>::operator=(const BasicMatrix& other) {
+    if (other.size() <= size()) {
+        std::copy(other.data_.get(), other.data_.get() + other.size(), data_.get());
+        nrows_ = other.nrows_;
+        ncols_ = other.ncols_;
+    } else {
+        BasicMatrix tmp(other);
+        std::swap(tmp.nrows_, nrows_);
+        std::swap(tmp.ncols_, ncols_);
+        std::swap(tmp.data_, data_);
+    }
+    return *this;
+}
+
+template<class T, class Layout>
+BasicMatrix<T, Layout>::BasicMatrix(BasicMatrix&& other)
+    : nrows_(other.nrows_)
+    , ncols_(other.ncols_)
+    , data_(std::move(other.data_)) {
+    other.ncols_ = other.nrows_ = 0ul;
+    other.data_ = nullptr;
+}
+
+template<class T, class Layout>
+BasicMatrix<T, Layout>& BasicMatrix<T, Layout>::operator=(BasicMatrix&& other) {
+    nrows_ = std::exchange(other.nrows_, 0ul);
+    ncols_ = std::exchange(other.ncols_, 0ul);
+    data_  = std::exchange(other.data_, nullptr);
+    return *this;
+}
+
+template<class T, class Layout>
+template<class Other, class>
+BasicMatrix<T, Layout>::BasicMatrix(const BasicMatrix<T, Other>& other)
+    : BasicMatrix(other.nrows(), other.ncols()) {
+    // other's storage is a row-major outer x inner matrix,
+    // the transposed one is ours
+    constexpr bool ROW_MAJOR = std::is_same_v<Other, RowMajor>;
+    const size_t outer = ROW_MAJOR ? nrows_ : ncols_;
+    const size_t inner = ROW_MAJOR ? ncols_ : nrows_;
+    kernels::Transpose(other.data(), inner, data_.get(), outer, outer, inner);
+}
+
+template<class T, class Layout>
+T  BasicMatrix<T, Layout>::Proxy::operator[](size_t j) const {
+    matrix.is_indices_valid(i, j);
+    return matrix.data_[matrix.index(i, j)];
+}
+template<class T, class Layout>
+T& BasicMatrix<T, Layout>::Proxy::operator[](size_t j) {
+    matrix.is_indices_valid(i, j);
+    return matrix.data_[matrix.index(i, j)];
+}
+
+template<class T, class Layout>
+const typename BasicMatrix<T, Layout>::Proxy BasicMatrix<T, Layout>::operator[](size_t i) const {
+    return {*this, i};
+}
+template<class T, class Layout>
+typename BasicMatrix<T, Layout>::Proxy BasicMatrix<T, Layout>::operator[](size_t i) {
+    return {*this, i};
+}
+
+template<class T, class Layout>
+T& BasicMatrix<T, Layout>::at(size_t i, size_t j) {
+    is_indices_valid(i, j);
+    return data_[index(i, j)];
+}
+template<class T, class Layout>
+T  BasicMatrix<T, Layout>::at(size_t i, size_t j) const {
+    is_indices_valid(i, j);
+    return data_[index(i, j)];
+}
+
+template<class T, class Layout>
+inline T BasicMatrix<T, Layout>::element(size_t idx) const {
+    return data_[idx];
+}
+
+template<class T, class Layout>
+template<class Check>
+inline typename BasicMatrix<T, Layout>::template Row<Check>
+BasicMatrix<T, Layout>::row(size_t i) {
+    Check::check(i, nrows_);
+    if constexpr (std::is_same_v<Layout, RowMajor>)
+        return {data_.get() + i * ncols_, ncols_};
+    else
+        return {data_.get() + i, nrows_, ncols_};
+}
+
+template<class T, class Layout>
+template<class Check>
+inline typename BasicMatrix<T, Layout>::template ConstRow<Check>
+BasicMatrix<T, Layout>::row(size_t i) const {
+    Check::check(i, nrows_);
+    if constexpr (std::is_same_v<Layout, RowMajor>)
+        return {data_.get() + i * ncols_, ncols_};
+    else
+        return {data_.get() + i, nrows_, ncols_};
+}
+
+template<class T, class Layout>
+template<class Check>
+inline typename BasicMatrix<T, Layout>::template Col<Check>
+BasicMatrix<T, Layout>::col(size_t j) {
+    Check::check(j, ncols_);
+    if constexpr (std::is_same_v<Layout, ColMajor>)
+        return {data_.get() + j * nrows_, nrows_};
+    else
+        return {data_.get() + j, ncols_, nrows_};
+}
+
+template<class T, class Layout>
+template<class Check>
+inline typename BasicMatrix<T, Layout>::template ConstCol<Check>
+BasicMatrix<T, Layout>::col(size_t j) const {
+    Check::check(j, ncols_);
+    if constexpr (std::is_same_v<Layout, ColMajor>)
+        return {data_.get() + j * nrows_, nrows_};
+    else
+        return {data_.get() + j, ncols_, nrows_};
+}
+
+template<class T, class Layout>
+inline T* BasicMatrix<T, Layout>::data() {
+    return data_.get();
+}
+
+template<class T, class Layout>
+inline const T* BasicMatrix<T, Layout>::data() const {
+    return data_.get();
+}
+
+template<class T, class Layout>
+template<class E, class Op>
+void BasicMatrix<T, Layout>::assign(const MatrixExpr<E>& expr, Op op) {
+    static_assert(std::is_same_v<typename E::value_type, T>, "Different element types");
+    static_assert(std::is_same_v<typename E::layout_type, Layout>, "Different layouts");
+    const E& e = expr.self();
+    if (e.nrows() != nrows_ || e.ncols() != ncols_)
+        throw std::logic_error("Different dimensions");
+    // an element only depends on the operands' elements at the same index,
+    // so writing into an operand (a = a + b) is safe
+    T* data = data_.get();
+    for (size_t idx = 0, n = size(); idx < n; idx++)
+        data[idx] = op(data[idx], e.element(idx));
+}
+
+template<class T, class Layout>
+template<class E>
+BasicMatrix<T, Layout>::BasicMatrix(const MatrixExpr<E>& expr)
+    : BasicMatrix(expr.self().nrows(), expr.self().ncols()) {
+    assign(expr, [](T, T value) { return value; });
+}
+
+template<class T, class Layout>
+template<class E>
+BasicMatrix<T, Layout>& BasicMatrix<T, Layout>::operator=(const MatrixExpr<E>& expr) {
+    if (expr.self().nrows() != nrows_ || expr.self().ncols() != ncols_)
+        return *this = BasicMatrix(expr);
+    assign(expr, [](T, T value) { return value; });
+    return *this;
+}
+
+template<class T, class Layout>
+template<class E>
+BasicMatrix<T, Layout>& BasicMatrix<T, Layout>::operator+=(const MatrixExpr<E>& expr) {
+    assign(expr, expr_detail::Plus::apply<T>);
+    return *this;
+}
+
+template<class T, class Layout>
+template<class E>
+BasicMatrix<T, Layout>& BasicMatrix<T, Layout>::operator-=(const MatrixExpr<E>& expr) {
+    assign(expr, expr_detail::Minus::apply<T>);
+    return *this;
+}
+
+template<class T, class Layout>
+BasicMatrix<T, Layout>& BasicMatrix<T, Layout>::operator*=(T alpha) {
+    kernels::Scale(data_.get(), size(), alpha);
+    return *this;
+}
+
+template<class T, class Layout>
+BasicMatrix<T, Layout> BasicMatrix<T, Layout>::product(const BasicMatrix& lhs,
+                                                       const BasicMatrix& rhs) {
+    if (lhs.ncols_ != rhs.nrows_)
+        throw std::logic_error("Different dimensions");
+    BasicMatrix res(lhs.nrows_, rhs.ncols_);
+    if constexpr (std::is_same_v<Layout, RowMajor>) {
+        kernels::Gemm(lhs.data_.get(), rhs.data_.get(), res.data_.get(),
+                      lhs.nrows_, rhs.ncols_, lhs.ncols_);
+    } else {
+        // column-major storage of X is row-major storage of X^T,
+        // and (lhs * rhs)^T = rhs^T * lhs^T
+        kernels::Gemm(rhs.data_.get(), lhs.data_.get(), res.data_.get(),
+                      rhs.ncols_, lhs.nrows_, lhs.ncols_);
+    }
+    return res;
+}
+
+template<class T, class Layout>
+BasicMatrix<T, Layout> BasicMatrix<T, Layout>::transposed() const {
+    BasicMatrix res(ncols_, nrows_);
+    // the storage is a row-major outer x inner matrix in both layouts
+    constexpr bool ROW_MAJOR = std::is_same_v<Layout, RowMajor>;
+    const size_t outer = ROW_MAJOR ? nrows_ : ncols_;
+    const size_t inner = ROW_MAJOR ? ncols_ : nrows_;
+    kernels::Transpose(data_.get(), inner, res.data_.get(), outer, outer, inner);
+    return res;
+}
+
+template<class T, class Layout>
+BasicMatrix<T, Layout>& BasicMatrix<T, Layout>::transpose() {
+    if (nrows_ != ncols_)
+        return *this = transposed();
+    kernels::TransposeInPlace(data_.get(), nrows_);
+    return *this;
+}
+
+template<class T, class Layout>
+bool BasicMatrix<T, Layout>::operator==(const BasicMatrix& other) const {
+    return std::tie(ncols_, nrows_) == std::tie(other.ncols_, other.nrows_) &&
+           std::equal(data_.get(), data_.get() + size(), other.data_.get());
+}
+template<class T, class Layout>
+bool BasicMatrix<T, Layout>::operator!=(const BasicMatrix& other) const {
+    return !(*this == other);
+}
+
+template<class T, class Layout>
+size_t BasicMatrix<T, Layout>::size()  const { return nrows_ * ncols_; }
+template<class T, class Layout>
+size_t BasicMatrix<T, Layout>::nrows() const { return nrows_; }
+template<class T, class Layout>
+size_t BasicMatrix<T, Layout>::ncols() const { return ncols_; }
+
+template<class T, class Layout>
+void BasicMatrix<T, Layout>::is_indices_valid(size_t i, size_t j) const {
+    if (i >= nrows_ || j >= ncols_)
+        throw std::out_of_range("Bad indices");
+}
+
+template<class T, class Layout>
+size_t BasicMatrix<T, Layout>::index(size_t i, size_t j) const {
+    return Layout::index(i, j, nrows_, ncols_);
+}
+
+template<class T, class Layout>
+std::ostream& operator<<(std::ostream& os, const BasicMatrix<T, Layout>& matr) {
+    for (size_t i = 0; i < matr.nrows(); ++i)
+        for (size_t j = 0; j <  matr.ncols(); ++j)
+            os << matr[i][j] << " \n"[j == matr.ncols() - 1];
+    return os;
+}
+
+template<class T, class Layout>
+std::istream& operator>>(std::istream& is, BasicMatrix<T, Layout>& m) {
+    BasicMatrix<T, Layout> tmp(m.nrows(), m.ncols());
+    for (size_t i = 0; i < tmp.nrows(); ++i)
+        for (size_t j = 0; j <  tmp.ncols(); ++j)
+            is >> tmp[i][j];
+    if (!is)
+        throw std::runtime_error("Not enough elems!");
+    m = std::move(tmp);
+    return is;
+}
+
+#endif  // MATRIX_TCC
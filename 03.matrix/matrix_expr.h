@@ -0,0 +1,136 @@
+#ifndef MATRIX_EXPR_H
+#define MATRIX_EXPR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+#include "kernels.h"
+
+template<class T, class Layout>
+class BasicMatrix;
+
+// Lazy elementwise arithmetic over BasicMatrix. a + b - 2 * c builds a tree
+// of small nodes, nothing is computed until it is assigned to a matrix,
+// which then evaluates every element in a single pass without temporaries.
+// Nodes keep references to the matrix operands: an expression must not
+// outlive them, so do not store it in `auto`.
+// Operands share the element type and the layout, element(idx) is the
+// element at index idx of the storage. Integers wrap around as in the kernels.
+template<class E>
+struct MatrixExpr {
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+namespace expr_detail {
+
+template<class E>
+struct IsMatrix : std::false_type {};
+
+template<class T, class Layout>
+struct IsMatrix<BasicMatrix<T, Layout>> : std::true_type {};
+
+// Matrix leaves by reference, nested nodes by value
+template<class E>
+using Operand = std::conditional_t<IsMatrix<E>::value, const E&, const E>;
+
+template<class E>
+using Value = typename E::value_type;
+
+struct Plus {
+    template<class T>
+    static T apply(T a, T b) {
+        using Arith = kernels::Arith<T>;
+        return static_cast<T>(static_cast<Arith>(a) + static_cast<Arith>(b));
+    }
+};
+
+struct Minus {
+    template<class T>
+    static T apply(T a, T b) {
+        using Arith = kernels::Arith<T>;
+        return static_cast<T>(static_cast<Arith>(a) - static_cast<Arith>(b));
+    }
+};
+
+}  // namespace expr_detail
+
+template<class Op, class L, class R>
+class BinaryExpr : public MatrixExpr<BinaryExpr<Op, L, R>> {
+    static_assert(std::is_same_v<typename L::value_type, typename R::value_type>,
+                  "Operands of different element types");
+    static_assert(std::is_same_v<typename L::layout_type, typename R::layout_type>,
+                  "Operands of different layouts");
+
+ public:
+    using value_type  = typename L::value_type;
+    using layout_type = typename L::layout_type;
+
+    BinaryExpr(const L& lhs, const R& rhs)
+        : lhs_(lhs), rhs_(rhs) {
+        if (lhs.nrows() != rhs.nrows() || lhs.ncols() != rhs.ncols())
+            throw std::logic_error("Different dimensions");
+    }
+
+    value_type element(size_t idx) const {
+        return Op::apply(lhs_.element(idx), rhs_.element(idx));
+    }
+
+    size_t nrows() const { return lhs_.nrows(); }
+    size_t ncols() const { return lhs_.ncols(); }
+
+ private:
+    expr_detail::Operand<L> lhs_;
+    expr_detail::Operand<R> rhs_;
+};
+
+template<class E>
+class ScaledExpr : public MatrixExpr<ScaledExpr<E>> {
+ public:
+    using value_type  = typename E::value_type;
+    using layout_type = typename E::layout_type;
+
+    ScaledExpr(const E& expr, value_type alpha)
+        : expr_(expr), alpha_(alpha) {}
+
+    value_type element(size_t idx) const {
+        using Arith = kernels::Arith<value_type>;
+        return static_cast<value_type>(static_cast<Arith>(expr_.element(idx)) *
+                                       static_cast<Arith>(alpha_));
+    }
+
+    size_t nrows() const { return expr_.nrows(); }
+    size_t ncols() const { return expr_.ncols(); }
+
+ private:
+    expr_detail::Operand<E> expr_;
+    value_type alpha_;
+};
+
+template<class L, class R>
+BinaryExpr<expr_detail::Plus, L, R> operator+(const MatrixExpr<L>& lhs, const MatrixExpr<R>& rhs) {
+    return {lhs.self(), rhs.self()};
+}
+
+template<class L, class R>
+BinaryExpr<expr_detail::Minus, L, R> operator-(const MatrixExpr<L>& lhs, const MatrixExpr<R>& rhs) {
+    return {lhs.self(), rhs.self()};
+}
+
+template<class E>
+ScaledExpr<E> operator*(const MatrixExpr<E>& expr, expr_detail::Value<E> alpha) {
+    return {expr.self(), alpha};
+}
+
+template<class E>
+ScaledExpr<E> operator*(expr_detail::Value<E> alpha, const MatrixExpr<E>& expr) {
+    return {expr.self(), alpha};
+}
+
+template<class E>
+ScaledExpr<E> operator-(const MatrixExpr<E>& expr) {
+    return {expr.self(), static_cast<expr_detail::Value<E>>(-1)};
+}
+
+#endif  // MATRIX_EXPR_H
@@ -0,0 +1,61 @@
+#ifndef MATRIX_PARALLEL_H
+#define MATRIX_PARALLEL_H
+
+#include <cstddef>
+
+#include "ThreadPool.h"
+#include "matrix.h"
+
+// Multithreaded versions of the large matrix operations. The work is cut
+// into blocks, one per pool thread and one for the calling thread, which
+// runs its block and then waits for the rest: cache-line-aligned ranges
+// of the storage for elementwise operations, blocks of whole rows of the
+// row-major view of the storage for transposes and products.
+// Smaller jobs stay on the calling thread.
+
+// Elementwise operations and transposes of fewer elements are not split
+constexpr size_t PARALLEL_MIN_ELEMENTS = 1u << 15;
+// nor are products of fewer multiplications
+constexpr size_t PARALLEL_MIN_PRODUCT = 1u << 21;
+
+// Pool of std::thread::hardware_concurrency() - 1 threads, used by the
+// overloads without a pool; created on first use.
+ThreadPool& MatrixPool();
+
+// dst = expr, resizing dst if needed
+template<class T, class Layout, class E>
+void AssignParallel(BasicMatrix<T, Layout>& dst, const MatrixExpr<E>& expr, ThreadPool& pool);
+template<class T, class Layout, class E>
+void AssignParallel(BasicMatrix<T, Layout>& dst, const MatrixExpr<E>& expr);
+
+// lhs + rhs
+template<class T, class Layout>
+BasicMatrix<T, Layout> AddParallel(const BasicMatrix<T, Layout>& lhs,
+                                   const BasicMatrix<T, Layout>& rhs, ThreadPool& pool);
+template<class T, class Layout>
+BasicMatrix<T, Layout> AddParallel(const BasicMatrix<T, Layout>& lhs,
+                                   const BasicMatrix<T, Layout>& rhs);
+
+// m *= alpha
+template<class T, class Layout>
+void ScaleParallel(BasicMatrix<T, Layout>& m, T alpha, ThreadPool& pool);
+template<class T, class Layout>
+void ScaleParallel(BasicMatrix<T, Layout>& m, T alpha);
+
+// m.transposed()
+template<class T, class Layout>
+BasicMatrix<T, Layout> TransposeParallel(const BasicMatrix<T, Layout>& m, ThreadPool& pool);
+template<class T, class Layout>
+BasicMatrix<T, Layout> TransposeParallel(const BasicMatrix<T, Layout>& m);
+
+// lhs * rhs
+template<class T, class Layout>
+BasicMatrix<T, Layout> ProductParallel(const BasicMatrix<T, Layout>& lhs,
+                                       const BasicMatrix<T, Layout>& rhs, ThreadPool& pool);
+template<class T, class Layout>
+BasicMatrix<T, Layout> ProductParallel(const BasicMatrix<T, Layout>& lhs,
+                                       const BasicMatrix<T, Layout>& rhs);
+
+#include "parallel.tcc"
+
+#endif  // MATRIX_PARALLEL_H
@@ -0,0 +1,168 @@
+#ifndef MATRIX_PARALLEL_TCC
+#define MATRIX_PARALLEL_TCC
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "parallel.h"
+#include "kernels.h"
+
+namespace parallel_detail {
+
+// Calls func(begin, end) for blocks covering [0, n) whose bounds are
+// multiples of align: all but the last on the pool, the last one here.
+// Everything runs here if split is false or the pool is empty.
+template<class Func>
+void ForBlocks(ThreadPool& pool, size_t n, size_t align, bool split, Func func) {
+    if (!split || pool.size() == 0u) {
+        func(size_t{0}, n);
+        return;
+    }
+    const size_t nblocks = pool.size() + 1u;
+    const size_t step = ((n + nblocks - 1u) / nblocks + align - 1u) / align * align;
+    std::vector<std::future<void>> done;
+    done.reserve(nblocks);
+    size_t begin = 0u;
+    for (; begin + step < n; begin += step)
+        done.push_back(pool.exec([&func, begin, step] { func(begin, begin + step); }));
+    // the tasks use func, so all of them finish before anything is thrown
+    std::exception_ptr error;
+    try {
+        func(begin, n);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    for (auto& f : done)
+        f.wait();
+    if (error)
+        std::rethrow_exception(error);
+    for (auto& f : done)
+        f.get();
+}
+
+// elements of T per cache line, blocks of this many elements
+// do not write to the same line
+template<class T>
+constexpr size_t LINE = MATRIX_ALIGNMENT / sizeof(T);
+
+}  // namespace parallel_detail
+
+inline ThreadPool& MatrixPool() {
+    static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1u);
+    return pool;
+}
+
+template<class T, class Layout, class E>
+void AssignParallel(BasicMatrix<T, Layout>& dst, const MatrixExpr<E>& expr, ThreadPool& pool) {
+    static_assert(std::is_same_v<typename E::value_type, T>, "Different element types");
+    static_assert(std::is_same_v<typename E::layout_type, Layout>, "Different layouts");
+    const E& e = expr.self();
+    if (e.nrows() != dst.nrows() || e.ncols() != dst.ncols()) {
+        // dst may be an operand, it is replaced only after the evaluation
+        BasicMatrix<T, Layout> res(e.nrows(), e.ncols());
+        AssignParallel(res, expr, pool);
+        dst = std::move(res);
+        return;
+    }
+    T* data = dst.data();
+    parallel_detail::ForBlocks(pool, dst.size(), parallel_detail::LINE<T>,
+                               dst.size() >= PARALLEL_MIN_ELEMENTS,
+                               [data, &e](size_t begin, size_t end) {
+        for (size_t idx = begin; idx < end; idx++)
+            data[idx] = e.element(idx);
+    });
+}
+
+template<class T, class Layout, class E>
+void AssignParallel(BasicMatrix<T, Layout>& dst, const MatrixExpr<E>& expr) {
+    AssignParallel(dst, expr, MatrixPool());
+}
+
+template<class T, class Layout>
+BasicMatrix<T, Layout> AddParallel(const BasicMatrix<T, Layout>& lhs,
+                                   const BasicMatrix<T, Layout>& rhs, ThreadPool& pool) {
+    BasicMatrix<T, Layout> res(lhs.nrows(), lhs.ncols());
+    AssignParallel(res, lhs + rhs, pool);
+    return res;
+}
+
+template<class T, class Layout>
+BasicMatrix<T, Layout> AddParallel(const BasicMatrix<T, Layout>& lhs,
+                                   const BasicMatrix<T, Layout>& rhs) {
+    return AddParallel(lhs, rhs, MatrixPool());
+}
+
+template<class T, class Layout>
+void ScaleParallel(BasicMatrix<T, Layout>& m, T alpha, ThreadPool& pool) {
+    T* data = m.data();
+    parallel_detail::ForBlocks(pool, m.size(), parallel_detail::LINE<T>,
+                               m.size() >= PARALLEL_MIN_ELEMENTS,
+                               [data, alpha](size_t begin, size_t end) {
+        kernels::Scale(data + begin, end - begin, alpha);
+    });
+}
+
+template<class T, class Layout>
+void ScaleParallel(BasicMatrix<T, Layout>& m, T alpha) {
+    ScaleParallel(m, alpha, MatrixPool());
+}
+
+template<class T, class Layout>
+BasicMatrix<T, Layout> TransposeParallel(const BasicMatrix<T, Layout>& m, ThreadPool& pool) {
+    BasicMatrix<T, Layout> res(m.ncols(), m.nrows());
+    // as in transposed(), the storage is a row-major outer x inner matrix
+    constexpr bool ROW_MAJOR = std::is_same_v<Layout, RowMajor>;
+    const size_t outer = ROW_MAJOR ? m.nrows() : m.ncols();
+    const size_t inner = ROW_MAJOR ? m.ncols() : m.nrows();
+    const T* src = m.data();
+    T* dst = res.data();
+    // a block of source rows is a block of destination columns
+    parallel_detail::ForBlocks(pool, outer, parallel_detail::LINE<T>,
+                               m.size() >= PARALLEL_MIN_ELEMENTS,
+                               [=](size_t begin, size_t end) {
+        kernels::Transpose(src + begin * inner, inner, dst + begin, outer, end - begin, inner);
+    });
+    return res;
+}
+
+template<class T, class Layout>
+BasicMatrix<T, Layout> TransposeParallel(const BasicMatrix<T, Layout>& m) {
+    return TransposeParallel(m, MatrixPool());
+}
+
+template<class T, class Layout>
+BasicMatrix<T, Layout> ProductParallel(const BasicMatrix<T, Layout>& lhs,
+                                       const BasicMatrix<T, Layout>& rhs, ThreadPool& pool) {
+    if (lhs.ncols() != rhs.nrows())
+        throw std::logic_error("Different dimensions");
+    BasicMatrix<T, Layout> res(lhs.nrows(), rhs.ncols());
+    // the row-major problem a (m x k) * b (k x n), for column-major
+    // matrices the transposed one, as in operator*
+    constexpr bool ROW_MAJOR = std::is_same_v<Layout, RowMajor>;
+    const T* a = ROW_MAJOR ? lhs.data() : rhs.data();
+    const T* b = ROW_MAJOR ? rhs.data() : lhs.data();
+    const size_t m = ROW_MAJOR ? lhs.nrows() : rhs.ncols();
+    const size_t n = ROW_MAJOR ? rhs.ncols() : lhs.nrows();
+    const size_t k = lhs.ncols();
+    T* c = res.data();
+    // blocks of whole GEMM_MR-row tiles of c
+    parallel_detail::ForBlocks(pool, m, kernels::GEMM_MR, m * n * k >= PARALLEL_MIN_PRODUCT,
+                               [=](size_t begin, size_t end) {
+        kernels::Gemm(a + begin * k, b, c + begin * n, end - begin, n, k);
+    });
+    return res;
+}
+
+template<class T, class Layout>
+BasicMatrix<T, Layout> ProductParallel(const BasicMatrix<T, Layout>& lhs,
+                                       const BasicMatrix<T, Layout>& rhs) {
+    return ProductParallel(lhs, rhs, MatrixPool());
+}
+
+#endif  // MATRIX_PARALLEL_TCC
@@ -1,7 +1,17 @@
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <limits>
+#include <random>
 #include <sstream>
+#include <vector>
 
 #include "test_runner.h"
 #include "matrix.h"
+#include "fixed_matrix.h"
+#include "parallel.h"
 
 void TestConstructor();
 void TestAt();
@@ -9,6 +19,16 @@ void TestOperatorBrackets();
 void TestComparison();
 void TestSum();
 void TestCoeff();
+void TestLargeElementwise();
+void TestProduct();
+void TestExpressions();
+void TestRows();
+void TestElementTypes();
+void TestColMajor();
+void TestFixedMatrix();
+void TestTranspose();
+void TestParallel();
+void TestParallelThresholds();
 
 void TestConstructor() {
     {
@@ -198,6 +218,506 @@ void TestCoeff() {
     }
 }
 
+namespace {
+
+Matrix Random(size_t nrows, size_t ncols, std::mt19937& gen) {
+    std::uniform_int_distribution<int32_t> dist;
+    Matrix m(nrows, ncols);
+    for (size_t i = 0; i < nrows; i++)
+        for (size_t j = 0; j < ncols; j++)
+            m[i][j] = dist(gen);
+    return m;
+}
+
+// products wrap around modulo 2^32 like the kernels
+Matrix NaiveProduct(const Matrix& lhs, const Matrix& rhs) {
+    Matrix res(lhs.nrows(), rhs.ncols());
+    for (size_t i = 0; i < lhs.nrows(); i++) {
+        for (size_t j = 0; j < rhs.ncols(); j++) {
+            uint32_t sum = 0u;
+            for (size_t p = 0; p < lhs.ncols(); p++)
+                sum += static_cast<uint32_t>(lhs[i][p]) * static_cast<uint32_t>(rhs[p][j]);
+            res[i][j] = static_cast<int32_t>(sum);
+        }
+    }
+    return res;
+}
+
+}  // namespace
+
+void TestLargeElementwise() {
+    std::mt19937 gen(42);
+    for (size_t ncols : {1u, 7u, 8u, 9u, 31u}) {
+        Matrix lhs = Random(3, ncols, gen);
+        Matrix rhs = Random(3, ncols, gen);
+        Matrix sum = lhs + rhs;
+        Matrix scaled = lhs;
+        scaled *= -7;
+        for (size_t i = 0; i < 3; i++) {
+            for (size_t j = 0; j < ncols; j++) {
+                uint32_t l = lhs[i][j], r = rhs[i][j];
+                ASSERT_EQUAL(sum[i][j], static_cast<int32_t>(l + r));
+                ASSERT_EQUAL(scaled[i][j], static_cast<int32_t>(l * static_cast<uint32_t>(-7)));
+            }
+        }
+    }
+}
+
+void TestProduct() {
+    try {
+        Matrix a = Matrix(2, 3) * Matrix(2, 3);
+        ASSERT(false);
+    } catch(std::logic_error& e) {
+        ASSERT(true);
+    }
+    {
+        Matrix lhs(2, 3), rhs(3, 2);
+        std::istringstream("1 2 3\n4 5 6\n") >> lhs;
+        std::istringstream("7 8\n9 10\n11 12\n") >> rhs;
+        DoAssert(lhs * rhs, "58 64\n139 154\n");
+    }
+    ASSERT_EQUAL((Matrix(3, 0) * Matrix(0, 4)), Matrix(3, 4));
+
+    std::mt19937 gen(42);
+    const size_t dims[][3] = {
+        {1, 1, 1}, {5, 3, 17}, {4, 16, 16}, {33, 70, 9}, {7, 300, 260}, {9, 40, 600}
+    };
+    for (auto [m, k, n] : dims) {
+        Matrix lhs = Random(m, k, gen);
+        Matrix rhs = Random(k, n, gen);
+        ASSERT_EQUAL(lhs * rhs, NaiveProduct(lhs, rhs));
+    }
+}
+
+void TestExpressions() {
+    std::mt19937 gen(42);
+    const Matrix a = Random(5, 11, gen);
+    const Matrix b = Random(5, 11, gen);
+    const Matrix c = Random(5, 11, gen);
+    const Matrix d = Random(5, 11, gen);
+    auto expected = [&](auto func) {
+        Matrix res(5, 11);
+        for (size_t i = 0; i < 5; i++)
+            for (size_t j = 0; j < 11; j++)
+                res[i][j] = static_cast<int32_t>(func(static_cast<uint32_t>(a[i][j]),
+                                                      static_cast<uint32_t>(b[i][j]),
+                                                      static_cast<uint32_t>(c[i][j]),
+                                                      static_cast<uint32_t>(d[i][j])));
+        return res;
+    };
+    {
+        Matrix res = a + b + c + d;
+        ASSERT_EQUAL(res, expected([](uint32_t x, uint32_t y, uint32_t z, uint32_t w) {
+            return x + y + z + w;
+        }));
+    }
+    {
+        Matrix res = a - 3 * (b - c) + d * 2 - -a;
+        ASSERT_EQUAL(res, expected([](uint32_t x, uint32_t y, uint32_t z, uint32_t w) {
+            return x - 3u * (y - z) + w * 2u + x;
+        }));
+    }
+    {
+        Matrix res = a;
+        res = res + b;
+        res += c - d;
+        res -= 2 * a;
+        ASSERT_EQUAL(res, expected([](uint32_t x, uint32_t y, uint32_t z, uint32_t w) {
+            return x + y + (z - w) - 2u * x;
+        }));
+    }
+    {
+        Matrix res(1, 1);
+        res = a + b;
+        ASSERT_EQUAL(res.nrows(), 5u);
+        ASSERT_EQUAL(res.ncols(), 11u);
+        ASSERT_EQUAL(res, expected([](uint32_t x, uint32_t y, uint32_t, uint32_t) {
+            return x + y;
+        }));
+        ASSERT_EQUAL((a + b) * Matrix(11, 2), Matrix(5, 2));
+    }
+    try {
+        Matrix res(5, 11);
+        res += Matrix(11, 5) * 2;
+        ASSERT(false);
+    } catch(std::logic_error& e) {
+        ASSERT(true);
+    }
+    try {
+        Matrix res = a + b - Matrix(5, 10);
+        ASSERT(false);
+    } catch(std::logic_error& e) {
+        ASSERT(true);
+    }
+}
+
+namespace {
+
+template<class Func>
+bool ThrowsOutOfRange(Func func) {
+    try {
+        func();
+    } catch (const std::out_of_range&) {
+        return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+void TestRows() {
+    Matrix m(3, 4);
+    for (size_t i = 0; i < 3; i++) {
+        Matrix::Row<> row = m.row(i);
+        ASSERT_EQUAL(row.size(), 4u);
+        for (size_t j = 0; j < row.size(); j++)
+            row[j] = i * 10 + j;
+    }
+    DoAssert(m, "0 1 2 3\n10 11 12 13\n20 21 22 23\n");
+
+    const Matrix& cm = m;
+    int32_t sum = 0;
+    for (int32_t el : cm.row(2))
+        sum += el;
+    ASSERT_EQUAL(sum, 86);
+    ASSERT_EQUAL(cm.row(1).data(), cm.data() + 4);
+    ASSERT_EQUAL(cm.data()[11], 23);
+    m.data()[0] = 7;
+    ASSERT_EQUAL(m[0][0], 7);
+    ASSERT_EQUAL(Matrix(100, 0).row(5).size(), 0u);
+
+    // columns of a row-major matrix are strided views into it
+    Matrix::Col<> col = m.col(2);
+    ASSERT_EQUAL(col.size(), 3u);
+    ASSERT_EQUAL(col.stride(), 4u);
+    ASSERT_EQUAL(std::vector<int32_t>(cm.col(2).begin(), cm.col(2).end()),
+                 std::vector<int32_t>({2, 12, 22}));
+    col[1] = -1;
+    ASSERT_EQUAL(m[1][2], -1);
+    for (int32_t& el : m.col(0))
+        el = 5;
+    DoAssert(m, "5 1 2 3\n5 11 -1 13\n5 21 22 23\n");
+    ASSERT_EQUAL(Matrix(0, 3).col(2).size(), 0u);
+
+    // and rows of a column-major one
+    BasicMatrix<int32_t, ColMajor> cols(2, 3);
+    std::istringstream("1 2 3\n4 5 6\n") >> cols;
+    ASSERT_EQUAL(cols.row(1).stride(), 2u);
+    ASSERT_EQUAL(std::vector<int32_t>(cols.row(1).begin(), cols.row(1).end()),
+                 std::vector<int32_t>({4, 5, 6}));
+    cols.row(0)[2] = 9;
+    ASSERT_EQUAL(cols.at(0, 2), 9);
+
+    // the Checked policy checks the index and the view's operator[]
+    ASSERT_EQUAL(cm.row<Checked>(2)[3], 23);
+    ASSERT_EQUAL(cols.row<Checked>(1)[2], 6);
+    ASSERT(ThrowsOutOfRange([&] { m.row<Checked>(3); }));
+    ASSERT(ThrowsOutOfRange([&] { cm.row<Checked>(0)[4]; }));
+    ASSERT(ThrowsOutOfRange([&] { cm.col<Checked>(4); }));
+    ASSERT(ThrowsOutOfRange([&] { cm.col<Checked>(0)[3]; }));
+    ASSERT(ThrowsOutOfRange([&] { cols.row<Checked>(0)[3]; }));
+    ASSERT(ThrowsOutOfRange([&] { cols.col<Checked>(2)[2]; }));
+    // at() of any view does
+    ASSERT(ThrowsOutOfRange([&] { cm.row(0).at(4); }));
+    ASSERT(ThrowsOutOfRange([&] { cm.col(0).at(3); }));
+#if defined(DEBUG)
+    ASSERT(ThrowsOutOfRange([&] { m.row<DebugChecked>(3); }));
+    ASSERT(ThrowsOutOfRange([&] { cm.col<DebugChecked>(0)[3]; }));
+#else
+    static_assert(std::is_same_v<DebugChecked, Unchecked>);
+#endif
+}
+
+namespace {
+
+// small integers, so that float sums are exact
+template<class T, class Layout>
+BasicMatrix<T, Layout> RandomOf(size_t nrows, size_t ncols, std::mt19937& gen) {
+    std::uniform_int_distribution<int> dist(-50, 50);
+    BasicMatrix<T, Layout> m(nrows, ncols);
+    for (size_t i = 0; i < nrows; i++)
+        for (size_t j = 0; j < ncols; j++)
+            m[i][j] = static_cast<T>(dist(gen));
+    return m;
+}
+
+template<class T, class Layout>
+BasicMatrix<T, Layout> NaiveProductOf(const BasicMatrix<T, Layout>& lhs,
+                                      const BasicMatrix<T, Layout>& rhs) {
+    BasicMatrix<T, Layout> res(lhs.nrows(), rhs.ncols());
+    for (size_t i = 0; i < lhs.nrows(); i++)
+        for (size_t j = 0; j < rhs.ncols(); j++)
+            for (size_t p = 0; p < lhs.ncols(); p++)
+                res[i][j] += lhs[i][p] * rhs[p][j];
+    return res;
+}
+
+template<class T, class Layout>
+void CheckElementType() {
+    std::mt19937 gen(42);
+    const std::vector<std::array<size_t, 3>> dims = {
+        {1, 1, 1}, {5, 3, 17}, {33, 70, 9}, {7, 300, 260}
+    };
+    for (auto [m, k, n] : dims) {
+        auto lhs = RandomOf<T, Layout>(m, k, gen);
+        auto rhs = RandomOf<T, Layout>(k, n, gen);
+        ASSERT_EQUAL(reinterpret_cast<uintptr_t>(lhs.data()) % MATRIX_ALIGNMENT, 0u);
+        ASSERT_EQUAL(lhs * rhs, NaiveProductOf(lhs, rhs));
+
+        auto other = RandomOf<T, Layout>(m, k, gen);
+        BasicMatrix<T, Layout> sum(m, k), scaled(m, k);
+        for (size_t i = 0; i < m; i++) {
+            for (size_t j = 0; j < k; j++) {
+                sum[i][j] = lhs[i][j] + 2 * other[i][j] + lhs[i][j];
+                scaled[i][j] = 3 * other[i][j];
+            }
+        }
+        BasicMatrix<T, Layout> res = lhs + 2 * other - -lhs;
+        ASSERT_EQUAL(res, sum);
+        other *= 3;
+        ASSERT_EQUAL(other, scaled);
+    }
+}
+
+}  // namespace
+
+void TestElementTypes() {
+    CheckElementType<int32_t, RowMajor>();
+    CheckElementType<int64_t, RowMajor>();
+    CheckElementType<float,   RowMajor>();
+    CheckElementType<double,  RowMajor>();
+    {
+        BasicMatrix<double> m(2, 2);
+        std::istringstream("0.5 1\n-2 4.25\n") >> m;
+        m *= 2.0;
+        std::ostringstream os;
+        os << m;
+        ASSERT_EQUAL(os.str(), "1 2\n-4 8.5\n");
+    }
+    {
+        // int64_t does not wrap at 2^32
+        BasicMatrix<int64_t> m(1, 1);
+        m[0][0] = int64_t{1} << 40;
+        m *= 4;
+        ASSERT_EQUAL(m[0][0], int64_t{1} << 42);
+    }
+}
+
+void TestColMajor() {
+    CheckElementType<int32_t, ColMajor>();
+    CheckElementType<int64_t, ColMajor>();
+    CheckElementType<float,   ColMajor>();
+    CheckElementType<double,  ColMajor>();
+
+    BasicMatrix<int32_t, ColMajor> m(2, 3);
+    std::istringstream("1 2 3\n4 5 6\n") >> m;
+    ASSERT_EQUAL(m.at(1, 0), 4);
+    ASSERT_EQUAL(std::vector<int32_t>(m.data(), m.data() + m.size()),
+                 std::vector<int32_t>({1, 4, 2, 5, 3, 6}));
+    ASSERT_EQUAL(m.col(2).size(), 2u);
+    ASSERT_EQUAL(std::vector<int32_t>(m.col(1).begin(), m.col(1).end()),
+                 std::vector<int32_t>({2, 5}));
+    BasicMatrix<int32_t, ColMajor> rhs(3, 1);
+    std::istringstream("1\n1\n1\n") >> rhs;
+    std::ostringstream os;
+    os << m * rhs;
+    ASSERT_EQUAL(os.str(), "6\n15\n");
+}
+
+void TestFixedMatrix() {
+    using Mat4 = FixedMatrix<float, 4, 4>;
+    constexpr Mat4 id = Mat4::Identity();
+    constexpr Mat4 translate({1, 0, 0, 5,
+                              0, 1, 0, 6,
+                              0, 0, 1, 7,
+                              0, 0, 0, 1});
+    static_assert(id * translate == translate);
+    static_assert(translate * translate == Mat4({1, 0, 0, 10,
+                                                 0, 1, 0, 12,
+                                                 0, 0, 1, 14,
+                                                 0, 0, 0, 1}));
+    static_assert(translate - id + id == translate);
+    static_assert(2.0f * id == id + id && -id + id == Mat4());
+
+    constexpr FixedMatrix<int32_t, 2, 3> lhs({1, 2, 3, 4, 5, 6});
+    constexpr FixedMatrix<int32_t, 3, 2> rhs({7, 8, 9, 10, 11, 12});
+    static_assert(lhs * rhs == FixedMatrix<int32_t, 2, 2>({58, 64, 139, 154}));
+    static_assert(FixedMatrix<int32_t, 2, 3>::size() == 6u);
+
+    FixedMatrix<int32_t, 2, 3> m = lhs;
+    m += lhs;
+    m -= FixedMatrix<int32_t, 2, 3>({1, 1, 1, 1, 1, 1});
+    m *= 10;
+    std::ostringstream os;
+    os << m;
+    ASSERT_EQUAL(os.str(), "10 30 50\n70 90 110\n");
+    m.at(0, 0) = std::numeric_limits<int32_t>::max();
+    m *= 2;
+    ASSERT_EQUAL(m[0][0], -2);
+    try {
+        m.at(2, 0) = 1;
+        ASSERT(false);
+    } catch(std::out_of_range& ex) {
+        ASSERT(true);
+    }
+}
+
+namespace {
+
+// blocked kernels against the definition, with ragged 8x8 blocks and tiles
+template<class T, class Layout>
+void CheckTranspose() {
+    using M = BasicMatrix<T, Layout>;
+    std::mt19937 gen(42);
+    for (size_t nrows : {1u, 8u, 13u, 64u, 150u}) {
+        for (size_t ncols : {1u, 7u, 16u, 71u, 150u}) {
+            const M m = RandomOf<T, Layout>(nrows, ncols, gen);
+            M res = m.transposed();
+            ASSERT_EQUAL(res.nrows(), ncols);
+            bool same = true;
+            for (size_t i = 0; i < nrows; i++)
+                for (size_t j = 0; j < ncols; j++)
+                    same = same && std::equal_to<T>()(res[j][i], m[i][j]);
+            ASSERT(same);
+            M in_place = m;
+            ASSERT_EQUAL(in_place.transpose(), res);
+            ASSERT_EQUAL(in_place.transpose(), m);
+        }
+    }
+}
+
+}  // namespace
+
+void TestTranspose() {
+    {
+        Matrix m(2, 3);
+        std::istringstream("1 2 3\n4 5 6\n") >> m;
+        DoAssert(m.transposed(), "1 4\n2 5\n3 6\n");
+        ASSERT_EQUAL(m.transposed().transposed(), m);
+        ASSERT_EQUAL(Matrix(0, 5).transposed(), Matrix(5, 0));
+    }
+    {
+        BasicMatrix<double, ColMajor> m(2, 3);
+        std::istringstream("1 2 3\n4 5 6\n") >> m;
+        std::ostringstream os;
+        os << m.transposed();
+        ASSERT_EQUAL(os.str(), "1 4\n2 5\n3 6\n");
+    }
+    CheckTranspose<int32_t, RowMajor>();
+    CheckTranspose<int64_t, RowMajor>();
+    CheckTranspose<float,   ColMajor>();
+    CheckTranspose<double,  ColMajor>();
+    {
+        // a copy in the other layout, contiguous columns but not a view
+        Matrix m(2, 3);
+        std::istringstream("1 2 3\n4 5 6\n") >> m;
+        BasicMatrix<int32_t, ColMajor> cols(m);
+        ASSERT_EQUAL(std::vector<int32_t>(cols.col(1).begin(), cols.col(1).end()),
+                     std::vector<int32_t>({2, 5}));
+        ASSERT_EQUAL(Matrix(cols), m);
+        cols.col(1)[0] = 0;
+        ASSERT_EQUAL(m.at(0, 1), 2);
+    }
+}
+
+namespace {
+
+template<class T, class Layout>
+void CheckParallel(ThreadPool& pool) {
+    using M = BasicMatrix<T, Layout>;
+    std::mt19937 gen(42);
+    // above the thresholds, with ragged last blocks
+    auto a = RandomOf<T, Layout>(201, 203, gen);
+    auto b = RandomOf<T, Layout>(201, 203, gen);
+    ASSERT(a.size() >= PARALLEL_MIN_ELEMENTS);
+    ASSERT_EQUAL(AddParallel(a, b, pool), M(a + b));
+    ASSERT_EQUAL(TransposeParallel(a, pool), a.transposed());
+
+    M res(1, 1);
+    AssignParallel(res, a - 2 * b, pool);
+    ASSERT_EQUAL(res, M(a - 2 * b));
+    AssignParallel(res, res + a, pool);
+    ASSERT_EQUAL(res, M(a - 2 * b + a));
+
+    M scaled = a;
+    ScaleParallel(scaled, T{3}, pool);
+    ASSERT_EQUAL(scaled, M(3 * a));
+
+    auto lhs = RandomOf<T, Layout>(131, 129, gen);
+    auto rhs = RandomOf<T, Layout>(129, 133, gen);
+    ASSERT(lhs.nrows() * rhs.ncols() * lhs.ncols() >= PARALLEL_MIN_PRODUCT);
+    ASSERT_EQUAL(ProductParallel(lhs, rhs, pool), lhs * rhs);
+    // the overloads without a pool use MatrixPool()
+    ASSERT_EQUAL(ProductParallel(rhs.transposed(), lhs.transposed()),
+                 rhs.transposed() * lhs.transposed());
+}
+
+}  // namespace
+
+void TestParallel() {
+    ThreadPool pool(3);
+    CheckParallel<int32_t, RowMajor>(pool);
+    CheckParallel<double,  RowMajor>(pool);
+    CheckParallel<float,   ColMajor>(pool);
+    CheckParallel<int64_t, ColMajor>(pool);
+    try {
+        ProductParallel(Matrix(2, 3), Matrix(2, 3), pool);
+        ASSERT(false);
+    } catch(std::logic_error& e) {
+        ASSERT(true);
+    }
+}
+
+namespace {
+
+// Whether func finishes within timeout while the only thread of pool is
+// busy: a job split over the pool waits for it, one that is not does not.
+template<class Func>
+bool FinishesWithPoolBusy(ThreadPool& pool, std::chrono::milliseconds timeout, Func func) {
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    auto busy = pool.exec([released] { released.wait(); });
+    auto job = std::async(std::launch::async, func);
+    const bool finished = job.wait_for(timeout) == std::future_status::ready;
+    release.set_value();
+    busy.get();
+    job.get();
+    return finished;
+}
+
+}  // namespace
+
+void TestParallelThresholds() {
+    ThreadPool pool(1);
+    // an empty pool never splits
+    if (pool.size() == 0u)
+        return;
+    std::mt19937 gen(42);
+    using Ms = std::chrono::milliseconds;
+
+    // just below the thresholds: never queued on the pool
+    auto a = RandomOf<int32_t, RowMajor>(127, 258, gen);
+    auto b = RandomOf<int32_t, RowMajor>(127, 258, gen);
+    ASSERT(a.size() < PARALLEL_MIN_ELEMENTS);
+    const Ms serial(10000);
+    ASSERT(FinishesWithPoolBusy(pool, serial, [&] { AddParallel(a, b, pool); }));
+    ASSERT(FinishesWithPoolBusy(pool, serial, [&] { ScaleParallel(a, 3, pool); }));
+    ASSERT(FinishesWithPoolBusy(pool, serial, [&] { TransposeParallel(a, pool); }));
+    ASSERT(FinishesWithPoolBusy(pool, serial, [&] { AssignParallel(a, a - b, pool); }));
+    auto lhs = RandomOf<int32_t, RowMajor>(127, 128, gen);
+    auto rhs = RandomOf<int32_t, RowMajor>(128, 128, gen);
+    ASSERT(lhs.nrows() * rhs.ncols() * lhs.ncols() < PARALLEL_MIN_PRODUCT);
+    ASSERT(FinishesWithPoolBusy(pool, serial, [&] { ProductParallel(lhs, rhs, pool); }));
+
+    // at the thresholds: split, so they wait for the pool
+    auto c = RandomOf<int32_t, RowMajor>(128, 256, gen);
+    ASSERT_EQUAL(c.size(), PARALLEL_MIN_ELEMENTS);
+    const Ms split(50);
+    ASSERT(!FinishesWithPoolBusy(pool, split, [&] { ScaleParallel(c, 3, pool); }));
+    auto square = RandomOf<int32_t, RowMajor>(128, 128, gen);
+    ASSERT(!FinishesWithPoolBusy(pool, split, [&] { ProductParallel(square, square, pool); }));
+}
+
 int main() {
     TestRunner tr;
     RUN_TEST(tr, TestConstructor);
@@ -206,4 +726,14 @@ int main() {
     RUN_TEST(tr, TestComparison);
     RUN_TEST(tr, TestSum);
     RUN_TEST(tr, TestCoeff);
+    RUN_TEST(tr, TestLargeElementwise);
+    RUN_TEST(tr, TestProduct);
+    RUN_TEST(tr, TestExpressions);
+    RUN_TEST(tr, TestRows);
+    RUN_TEST(tr, TestElementTypes);
+    RUN_TEST(tr, TestColMajor);
+    RUN_TEST(tr, TestFixedMatrix);
+    RUN_TEST(tr, TestTranspose);
+    RUN_TEST(tr, TestParallel);
+    RUN_TEST(tr, TestParallelThresholds);
 }
@@ -4,13 +4,7 @@
 #include <iterator>
 
 template<typename Iter>
-class Iterator : public std::iterator<
-    typename std::iterator_traits<Iter>::iterator_category,
-    typename std::iterator_traits<Iter>::value_type,
-    typename std::iterator_traits<Iter>::difference_type,
-    typename std::iterator_traits<Iter>::pointer,
-    typename std::iterator_traits<Iter>::reference
-> {
+class Iterator {
  protected:
     Iter _current;
 
@@ -26,11 +26,11 @@ class Vector {
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
  public:
-    explicit Vector(const Alloc& alloc = alloc::Allocator<T>());
-    explicit Vector(size_t size, const Alloc& alc = alloc::Allocator<T>());
-    Vector(size_t size, const T& default_value, const Alloc& alloc = alloc::Allocator<T>());
+    explicit Vector(const Alloc& alloc = Alloc());
+    explicit Vector(size_t size, const Alloc& alc = Alloc());
+    Vector(size_t size, const T& default_value, const Alloc& alloc = Alloc());
 
-    Vector(std::initializer_list<T> list, const Alloc& alloc = alloc::Allocator<T>());
+    Vector(std::initializer_list<T> list, const Alloc& alloc = Alloc());
     Vector& operator=(std::initializer_list<T> list);
 
     Vector(const Vector& other);
@@ -60,6 +60,8 @@ class Vector {
     const_reference front() const noexcept { return *begin(); }
     const_reference back()  const noexcept { return *std::prev(end()); }
 
+    allocator_type get_allocator() const noexcept { return _alloc; }
+
     pointer       data()       noexcept { return _begin; }
     const_pointer data() const noexcept { return _begin; }
 
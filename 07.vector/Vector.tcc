@@ -44,14 +44,15 @@ Vector<T, Alloc>::Vector(std::initializer_list<T> ilist, const Alloc& alloc)
 
 template<typename T, typename Alloc>
 Vector<T, Alloc>& Vector<T, Alloc>::operator=(std::initializer_list<T> ilist) {
-    Vector tmp(ilist);
+    Vector tmp(ilist, _alloc);
     this->swap(tmp);
     return *this;
 }
 
 template<typename T, typename Alloc>
 Vector<T, Alloc>::Vector(const Vector& other)
-    : _size(other._size)
+    : _alloc(other._alloc)
+    , _size(other._size)
     , _capacity(other._capacity)
     , _begin(_alloc.allocate(other._capacity)) {
     alloc::construct_from(other.begin(), other.end(), begin());
@@ -67,7 +68,8 @@ Vector<T, Alloc>& Vector<T, Alloc>::operator =(const Vector& rhs) {
 }
 
 template<typename T, typename Alloc>
-Vector<T, Alloc>::Vector(Vector&& other) noexcept {
+Vector<T, Alloc>::Vector(Vector&& other) noexcept
+    : _alloc(other._alloc) {
     this->swap(other);
 }
 
@@ -107,7 +109,7 @@ void Vector<T, Alloc>::resize(size_type count) {
         _size = count; return;
     }
 
-    Vector temp;
+    Vector temp(_alloc);
     temp.reserve(count);
     temp._size = count;
     std::move(begin(), end(), temp.begin());
@@ -117,6 +119,7 @@ void Vector<T, Alloc>::resize(size_type count) {
 
 template<typename T, typename Alloc>
 void Vector<T, Alloc>::swap(Vector& other) noexcept {
+    std::swap(other._alloc, _alloc);
     std::swap(other._begin, _begin);
     std::swap(other._size, _size);
     std::swap(other._capacity, _capacity);
@@ -1,5 +1,6 @@
 #include <string_view>
 
+#include "arena_resource.h"
 #include "test_runner.h"
 #include "Vector.h"
 
@@ -17,6 +18,8 @@ void TestResize();
 
 void TestComparison();
 
+void TestArenaAllocator();
+
 struct Counter {
     static inline size_t ctor_calls = 0;
     static inline size_t dtor_calls = 0;
@@ -314,6 +317,54 @@ void TestComparison() {
     ASSERT(Vector<int>({0, 1, 2}) <  Vector<int>({2, 1}));
 }
 
+void TestArenaAllocator() {
+    using ArenaVector = Vector<int, ArenaAllocator<int>>;
+    Allocator arena(4096);
+    Allocator other(4096);
+    const ArenaAllocator<int> in_arena(arena);
+    const ArenaAllocator<int> in_other(other);
+
+    ArenaVector vec({1, 2, 3}, in_arena);
+    ASSERT(vec.get_allocator() == in_arena);
+    size_t used = arena.stats().in_use;
+    ASSERT(used >= 3 * sizeof(int));
+
+    ArenaVector copy(vec);
+    ASSERT(copy.get_allocator() == in_arena);
+    ASSERT(copy == vec);
+    ASSERT(arena.stats().in_use > used);
+    used = arena.stats().in_use;
+
+    ArenaVector assigned({7}, in_other);
+    size_t other_used = other.stats().in_use;
+    assigned = copy;
+    ASSERT(assigned.get_allocator() == in_arena);
+    ASSERT(assigned == vec);
+    ASSERT(arena.stats().in_use > used);
+    used = arena.stats().in_use;
+
+    ArenaVector moved({8}, in_other);
+    other_used = other.stats().in_use;
+    moved = std::move(copy);
+    ASSERT(moved.get_allocator() == in_arena);
+    ASSERT(moved == vec);
+    ASSERT_EQUAL(arena.stats().in_use, used);
+
+    moved.resize(100);
+    ASSERT(moved.get_allocator() == in_arena);
+    ASSERT_EQUAL(moved.size(), 100ul);
+    ASSERT(arena.stats().in_use >= used + 100 * sizeof(int));
+    used = arena.stats().in_use;
+
+    moved = {4, 5};
+    ASSERT(moved.get_allocator() == in_arena);
+    ASSERT_EQUAL(moved.size(), 2ul);
+    ASSERT(moved[0] == 4 && moved[1] == 5);
+    ASSERT(arena.stats().in_use > used);
+    // nothing of the above went to the other arena
+    ASSERT_EQUAL(other.stats().in_use, other_used);
+}
+
 int main() {
     TestRunner tr;
     RUN_TEST(tr, TestConstruction);
@@ -328,4 +379,6 @@ int main() {
     RUN_TEST(tr, TestResize);
 
     RUN_TEST(tr, TestComparison);
+
+    RUN_TEST(tr, TestArenaAllocator);
 }
@@ -27,6 +27,9 @@ class ThreadPool final {
     template <class Func, class... Args>
     auto exec(Func func, Args&&... args) -> std::future<decltype(func(args...))>;
 
+    // threads, at most std::thread::hardware_concurrency()
+    size_t size() const;
+
  private:
     void wait();
 
@@ -7,7 +7,7 @@
 
 #include "ThreadPool.h"
 
-ThreadPool::ThreadPool(unsigned size) {
+inline ThreadPool::ThreadPool(unsigned size) {
     size = std::min(size, std::thread::hardware_concurrency());
     for(size_t i = 0; i < size; i++) {
         threads_.emplace_back([this] {
@@ -35,7 +35,11 @@ auto ThreadPool::exec(Func func, Args&&... args) -> std::future<decltype(func(ar
     return f;
 }
 
-void ThreadPool::wait() {
+inline size_t ThreadPool::size() const {
+    return threads_.size();
+}
+
+inline void ThreadPool::wait() {
     while (true) {
         std::function<void()> task;
         {
@@ -52,7 +56,7 @@ void ThreadPool::wait() {
     }
 }
 
-ThreadPool::~ThreadPool() {
+inline ThreadPool::~ThreadPool() {
     {
         std::lock_guard lk(tasks_mutex_);
         stop_ = true;
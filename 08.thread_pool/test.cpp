@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include <future>
 
@@ -38,10 +39,20 @@ void TestValid() {
     ASSERT(task2.get() == 1);
 }
 
+void TestSize() {
+    // clamped to hardware_concurrency(), which is 0 when it is unknown
+    const size_t hw = std::thread::hardware_concurrency();
+    for (unsigned size : {1u, 2u, 8u, 1024u}) {
+        ThreadPool pool(size);
+        ASSERT_EQUAL(pool.size(), std::min<size_t>(size, hw));
+    }
+}
+
 }  // namespace
 
 int main() {
     TestRunner tr;
     RUN_TEST(tr, TestEmpty);
     RUN_TEST(tr, TestValid);
+    RUN_TEST(tr, TestSize);
 }